@@ -0,0 +1,93 @@
+/*
+ * File:   adc.c
+ * Author: mdonze
+ *
+ * Created on 17 October 2026, 09:30
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc.h"
+#include "timing.h"
+
+//Conversion results
+static volatile uint16_t results[ADC_SLOW];
+//Result not read yet
+static volatile bool fresh[ADC_SLOW];
+//Conversion asked
+static bool pending[ADC_SLOW];
+//Conversion running
+static volatile bool converting = false;
+//Channel converting
+static uint8_t current = 0;
+//RFID owns the ADC
+static bool rfidOwned = false;
+
+/**
+ * Start the next conversion asked, if the ADC is free
+ */
+static void adcStart(void)
+{
+    if(converting || rfidOwned){
+        return;
+    }
+    for(uint8_t i=0;i<ADC_SLOW;++i){
+        if(pending[i]){
+            pending[i] = false;
+            current = i;
+            //Right justified result
+            ADCON1bits.ADFM = 1;
+            ADCON0 = ADC_CON0(i);
+            __delay_us(ADC_TACQ_US);
+            converting = true;
+            PIR1bits.ADIF = 0;
+            PIE1bits.ADIE = 1;
+            ADCON0bits.GO_DONE = 1;
+            return;
+        }
+    }
+}
+
+void adcQueue(uint8_t ch)
+{
+    if(!converting || (current != ch)){
+        pending[ch] = true;
+    }
+    adcStart();
+}
+
+bool adcResult(uint8_t ch, uint16_t* value)
+{
+    if(fresh[ch]){
+        *value = results[ch];
+        fresh[ch] = false;
+        return true;
+    }
+    adcQueue(ch);
+    return false;
+}
+
+void adcRFID(bool on)
+{
+    PIE1bits.ADIE = 0;
+    if(on && converting){
+        //Abort, done again when RFID is over
+        ADCON0bits.GO_DONE = 0;
+        converting = false;
+        pending[current] = true;
+    }
+    PIR1bits.ADIF = 0;
+    rfidOwned = on;
+    if(!on){
+        adcStart();
+    }
+}
+
+void adcISR(void)
+{
+    PIE1bits.ADIE = 0;
+    results[current] = ((uint16_t)ADRESH << 8) | ADRESL;
+    fresh[current] = true;
+    converting = false;
+}
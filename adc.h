@@ -0,0 +1,81 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: adc.h
+ * Author: mdonze
+ * Comments: ADC service. Light and flap conversions are queued and end in
+ *           the ADC interrupt. The RFID demodulator has priority and drives
+ *           the ADC itself while reading.
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef ADC_INCLUDED_H
+#define	ADC_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+//ADC channels
+//Light sensor (AN0)
+#define ADC_LIGHT 0
+//Flap potentiometer (AN1)
+#define ADC_FLAP 1
+//RFID demodulated stream (AN2)
+#define ADC_RFID 2
+//Channels converted by the service (lower first)
+#define ADC_SLOW 2
+
+//ADCON0 value for a channel, ADC on
+#define ADC_CON0(ch) (ADC_ADCS | ((ch) << 2) | 0x1)
+
+/**
+ * Queue a conversion of a channel, started as soon as the ADC is free
+ * @param ch ADC_LIGHT or ADC_FLAP
+ */
+void adcQueue(uint8_t ch);
+
+/**
+ * Get the last conversion of a channel. If there is none, a conversion is
+ * queued and started as soon as the ADC is free.
+ * @param ch ADC_LIGHT or ADC_FLAP
+ * @param value Conversion result (10 bits)
+ * @return true if a new result was read
+ */
+bool adcResult(uint8_t ch, uint16_t* value);
+
+/**
+ * Give the ADC to the RFID demodulator, a conversion in progress is
+ * aborted and done again later
+ * @param on true while RFID reads
+ */
+void adcRFID(bool on);
+
+/**
+ * End a conversion, called by the interrupt routine on ADIF
+ */
+void adcISR(void);
+
+#endif	/* ADC_INCLUDED_H */
+
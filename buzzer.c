@@ -0,0 +1,128 @@
+/*
+ * File:   buzzer.c
+ * Author: mdonze
+ *
+ * Created on 16 October 2026, 22:40
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "buzzer.h"
+#include "peripherials.h"
+
+#define TONE_MASK (TONE_QUEUE-1)
+#if (TONE_QUEUE & TONE_MASK) != 0
+#error "TONE_QUEUE must be a power of two"
+#endif
+
+//Time unit of patterns (ms)
+#define TONE_UNIT 10
+//Longest pattern (steps)
+#define TONE_STEPS 10
+//Silence between two queued patterns (TONE_UNIT)
+#define TONE_GAP 15
+
+//Patterns : tone, silence, tone... durations (TONE_UNIT), 0 ends
+static const uint8_t patterns[TONE_COUNT][TONE_STEPS] = {
+    {10, 0},                                //TONE_BEEP
+    {8, 8, 8, 0},                           //TONE_DOUBLE
+    {3, 3, 3, 3, 3, 3, 3, 0},               //TONE_ERROR
+    {10, 10, 10, 10, 10, 10, 10, 10, 10, 0} //TONE_CLEAR
+};
+
+//Patterns to play
+static volatile uint8_t queue[TONE_QUEUE];
+//Next pattern to play (ISR)
+static volatile uint8_t queueRead = 0;
+//Next free entry (main)
+static volatile uint8_t queueWrite = 0;
+//Pattern playing (0 if none, or between two patterns)
+static const uint8_t* step = 0;
+//Time left in the current step (ms)
+static uint16_t stepLeft = 0;
+//Tone is on in the current step
+static volatile bool toneOn = false;
+//Pattern playing or queued
+static volatile bool playing = false;
+
+void initBuzzer(void)
+{
+    //Timer 0 on instruction clock, with prescaler
+    OPTION_REGbits.T0CS = 0;
+    OPTION_REGbits.PSA = 0;
+    OPTION_REGbits.PS = TMR0_PS;
+    TMR0IE = 0;
+    BUZZER = 0;
+}
+
+bool playTone(uint8_t pattern)
+{
+    uint8_t next = (queueWrite+1) & TONE_MASK;
+    if((pattern >= TONE_COUNT) || (next == queueRead)){
+        return false;
+    }
+    queue[queueWrite] = pattern;
+    queueWrite = next;
+    playing = true;
+    return true;
+}
+
+bool buzzerBusy(void)
+{
+    return playing;
+}
+
+void buzzerTickISR(void)
+{
+    if(!playing){
+        return;
+    }
+    if(stepLeft != 0){
+        --stepLeft;
+        return;
+    }
+    if((step == 0) || (*step == 0)){
+        //Pattern done, next one
+        if(queueRead == queueWrite){
+            TMR0IE = 0;
+            BUZZER = 0;
+            toneOn = false;
+            step = 0;
+            playing = false;
+            return;
+        }
+        if(step != 0){
+            //Pattern just ended, keep it apart from the next one
+            step = 0;
+            toneOn = false;
+            BUZZER = 0;
+            TMR0IE = 0;
+            stepLeft = TONE_GAP * TONE_UNIT;
+            return;
+        }
+        step = patterns[queue[queueRead]];
+        queueRead = (queueRead+1) & TONE_MASK;
+        toneOn = false;
+    }
+    //Steps are tone, silence, tone...
+    toneOn = !toneOn;
+    stepLeft = (uint16_t)(*step) * TONE_UNIT;
+    ++step;
+    BUZZER = 0;
+    if(toneOn){
+        TMR0 = TMR0_PRES;
+        TMR0IF = 0;
+        TMR0IE = 1;
+    }else{
+        TMR0IE = 0;
+    }
+}
+
+void buzzerISR(void)
+{
+    TMR0 = TMR0_PRES;
+    if(toneOn){
+        BUZZER = !BUZZER;
+    }
+}
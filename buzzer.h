@@ -0,0 +1,81 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: buzzer.h
+ * Author: mdonze
+ * Comments: Buzzer tone patterns, played in background by Timer 0
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef BUZZER_INCLUDED_H
+#define	BUZZER_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+//Tone patterns
+//Single beep (cat allowed)
+#define TONE_BEEP 0
+//Two beeps (cat learned)
+#define TONE_DOUBLE 1
+//Fast chirps (error, nothing learned)
+#define TONE_ERROR 2
+//Five beeps (cats cleared)
+#define TONE_CLEAR 3
+#define TONE_COUNT 4
+
+//Patterns waiting to be played
+#define TONE_QUEUE 4
+
+/**
+ * Setup Timer 0 for the buzzer
+ */
+void initBuzzer(void);
+
+/**
+ * Queue a tone pattern, played in background
+ * @param pattern Tone pattern
+ * @return false if queue is full or pattern unknown
+ */
+bool playTone(uint8_t pattern);
+
+/**
+ * Is a pattern playing or waiting?
+ * @return true if busy
+ */
+bool buzzerBusy(void);
+
+/**
+ * Step tone patterns, called by the interrupt routine every millisecond
+ */
+void buzzerTickISR(void);
+
+/**
+ * Toggle the buzzer, called by the interrupt routine on Timer 0
+ */
+void buzzerISR(void);
+
+#endif	/* BUZZER_INCLUDED_H */
+
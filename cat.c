@@ -9,44 +9,99 @@
 #include <xc.h>
 #include "cat.h"
 #include "peripherials.h"
+#include "interrupts.h"
+#include "storage.h"
 
+/**
+ * Cat recently allowed to open the door
+ */
+typedef struct{
+    uint16_t crc;   //Chip CRC
+    uint8_t hash;   //Hash of the chip ID (0 if free)
+    ms_t opened;    //Time door was opened for it
+}RecentCat;
+
+//Recently opened cats, a repeat read is matched without reading EEPROM
+static RecentCat recent[RECENT_CATS];
+//Hash of the ID in each cat slot (0 if free)
+static uint8_t catHash[CAT_SLOTS];
 
-uint16_t getConfiguration(uint8_t cfg)
+/**
+ * Hash of a cat ID for the RAM index
+ * @param id Chip ID
+ * @return Hash, never 0
+ */
+static uint8_t hashId(uint8_t* id)
 {
-    uint16_t ret = 0;
-    uint8_t offset = cfg*2;
-    //Ensure we read the configuration area
-    if(offset<CAT_OFFSET){        
-        ret = eeprom_read(offset);
-        ret |= (eeprom_read(offset+1)<<8);
+    uint8_t h = 0;
+    for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+        h = ((h<<1) | (h>>7)) ^ id[i];
+    }
+    if(h == 0){
+        h = 1;
     }
-    return ret;
+    return h;
 }
 
-void setConfiguration(uint8_t cfg, uint16_t value)
+/**
+ * Compare a cat slot in EEPROM with an ID
+ * @param slot Cat slot
+ * @param id Chip ID
+ * @return true if the slot holds this ID
+ */
+static bool slotMatches(uint8_t slot, uint8_t* id)
 {
-    uint8_t offset = cfg*2;
-    //Ensure we write in the configuration area
-    if(offset<CAT_OFFSET){        
-        eeprom_write(offset, (value & 0xFF));
-        eeprom_write(offset+1, ((value>>8) & 0xFF));
-    }    
+    uint8_t sid[CAT_ID_SIZE];
+    storageReadId(slot, sid);
+    for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+        if(sid[i] != id[i]){
+            return false;
+        }
+    }
+    return true;
 }
 
-void getCat(Cat* cat, uint8_t slot)
+/**
+ * Find the slot of a cat, using the RAM index
+ * @param id Chip ID
+ * @return Cat slot, CAT_SLOTS if not found
+ */
+static uint8_t findCat(uint8_t* id)
+{
+    uint8_t h = hashId(id);
+    for(uint8_t i=0;i<CAT_SLOTS;++i){
+        //Only read EEPROM when the hash matches
+        if((catHash[i] == h) && slotMatches(i, id)){
+            return i;
+        }
+    }
+    return CAT_SLOTS;
+}
+
+void initCats(void)
 {
-    if(slot<CAT_SLOTS){
-        uint8_t offset = CAT_OFFSET+slot*sizeof(Cat);
-        cat->crc = eeprom_read(offset);
-        cat->crc |= (eeprom_read(offset+1)<<8);
-        offset +=2;
-        for(uint8_t i=0;i<6;++i){
-            cat->id[i] = eeprom_read(i+offset);
+    uint8_t id[CAT_ID_SIZE];
+    for(uint8_t i=0;i<RECENT_CATS;++i){
+        recent[i].hash = 0;
+    }
+    for(uint8_t i=0;i<CAT_SLOTS;++i){
+        catHash[i] = 0;
+        //Half written slots are not valid
+        if(storageReadId(i, id)){
+            catHash[i] = hashId(id);
         }
+    }
+}
+
+void getCat(Cat* cat, uint8_t slot)
+{
+    //CRC is not stored
+    cat->crc = 0x0;
+    if((slot<CAT_SLOTS) && (catHash[slot] != 0)){
+        storageReadId(slot, cat->id);
     }else{
         //Not found
-        cat->crc = 0x0;
-        for(uint8_t i=0;i<6;++i){
+        for(uint8_t i=0;i<CAT_ID_SIZE;++i){
             cat->id[i] = 0x0;
         }
     }
@@ -58,49 +113,69 @@ void getCat(Cat* cat, uint8_t slot)
  */
 uint8_t saveCat(Cat* cat)
 {
-    uint8_t offset = CAT_OFFSET;
+    uint8_t h = hashId(cat->id);
+    uint8_t slot = CAT_SLOTS;
     for(uint8_t i=0;i<CAT_SLOTS;++i){
-        uint8_t tCrc = eeprom_read(offset);
-        tCrc |= eeprom_read(offset+1);
-        if(tCrc == 0x0){
-            eeprom_write(offset, cat->crc & 0xFF);
-            eeprom_write(offset+1, ((cat->crc>>8) & 0xFF));
-            offset +=2;
-            for(uint8_t j=0;j<6;++j){
-                eeprom_write(j+offset, cat->id[j]);
-            }
-            return i+1;
-        }else if(tCrc == cat->crc){
+        if((catHash[i] == h) && slotMatches(i, cat->id)){
             //Already stored
             return i+1;
+        }else if((catHash[i] == 0) && (slot == CAT_SLOTS)){
+            slot = i;
         }
-        offset += sizeof(Cat);
     }
-    return 0;
+    if((slot == CAT_SLOTS) || (cat->id[CAT_ID_SIZE-1] == CAT_FREE)){
+        //No free slot, or not a valid ID
+        return 0;
+    }
+    storageWriteId(slot, cat->id);
+    catHash[slot] = h;
+    return slot+1;
 }
 
 /**
- * Locate a cat by it's CRC
- * @param crc
+ * Locate a cat by it's ID
+ * @param cat
+ * @param otherCrc
  * @return 
  */
 bool catExists(Cat* cat, uint16_t* otherCrc)
 {
-    uint8_t offset = CAT_OFFSET;
-    for(uint8_t i=0;i<CAT_SLOTS;++i){
-        uint16_t tCrc = eeprom_read(offset);
-        tCrc |= (eeprom_read(offset+1) << 8);
-        if((tCrc == cat->crc) &&
-                (*otherCrc != 0) && (*otherCrc == tCrc)){
-            offset +=2;
-            for(uint8_t j=0;j<6;++j){
-                cat->id[j] = eeprom_read(j+offset);
+    if((*otherCrc == 0) || (*otherCrc != cat->crc)){
+        return false;
+    }
+    return findCat(cat->id) != CAT_SLOTS;
+}
+
+uint8_t lookupCat(Cat* cat, uint16_t* otherCrc, ms_t window)
+{
+    if((*otherCrc == 0) || (*otherCrc != cat->crc)){
+        return CAT_UNKNOWN;
+    }
+    uint8_t h = hashId(cat->id);
+    ms_t now = millis();
+    RecentCat* slot = &recent[0];
+    for(uint8_t i=0;i<RECENT_CATS;++i){
+        RecentCat* r = &recent[i];
+        if((r->hash == h) && (r->crc == cat->crc)){
+            if((now-r->opened) < window){
+                return CAT_REPEAT;
             }
-            return true;
+            r->opened = now;
+            return CAT_KNOWN;
         }
-        offset = CAT_OFFSET + i*sizeof(Cat);
+        //Replace a free entry, or the oldest one
+        if((r->hash == 0) || ((slot->hash != 0) &&
+                ((now-r->opened) > (now-slot->opened)))){
+            slot = r;
+        }
+    }
+    if(findCat(cat->id) == CAT_SLOTS){
+        return CAT_UNKNOWN;
     }
-    return false;
+    slot->crc = cat->crc;
+    slot->hash = h;
+    slot->opened = now;
+    return CAT_KNOWN;
 }
 
 /**
@@ -108,15 +183,14 @@ bool catExists(Cat* cat, uint16_t* otherCrc)
  */
 void clearCats(void)
 {
-    uint8_t offset = CAT_OFFSET;
-    for(uint8_t i=0;i<CAT_SLOTS;++i){
-        //Only clear CRC
-        eeprom_write(offset, 0x0);
-        eeprom_write(offset+1, 0x0);
-        offset += sizeof(Cat);
+    for(uint8_t i=0;i<RECENT_CATS;++i){
+        recent[i].hash = 0;
     }
-    for(uint8_t i=0;i<5;++i){
-        beep();
-        __delay_ms(100);
+    for(uint8_t i=0;i<CAT_SLOTS;++i){
+        //Only mark used slots free
+        if(catHash[i] != 0){
+            storageFreeId(i);
+            catHash[i] = 0;
+        }
     }
 }
\ No newline at end of file
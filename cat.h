@@ -34,21 +34,20 @@
 #include <xc.h> // include processor files - each processor file is guarded.  
 #include <stdint.h>
 #include <stdbool.h>
+#include "interrupts.h"
+#include "storage.h"
 
-//Keep first 128 bytes for global settings
-#define CAT_OFFSET 128
-//(256-128)/8
-#define CAT_SLOTS 16
+//Number of recently opened cats kept in RAM
+#define RECENT_CATS 4
+
+//Result of a cat lookup
+//Not a known cat
+#define CAT_UNKNOWN 0
+//Known cat, door can be opened
+#define CAT_KNOWN 1
+//Known cat, already opened within the reopen window
+#define CAT_REPEAT 2
 
-//Offset of configuration
-//Light threshold value
-#define LIGHT_CFG 0
-#ifdef FLAP_POT
-    //Flap middle position
-    #define FLAP_POS_IDLE 1
-    //Flap middle position margin
-    #define FLAP_POS_MARGIN 2
-#endif
 /**
  Define a cat in the 
  **/
@@ -58,21 +57,12 @@ typedef struct{
 }Cat;
 
 /**
- * Gets a configuration
- * @param cfg
- * @return 
- */
-uint16_t getConfiguration(uint8_t cfg);
-
-/**
- * Sets a configuration
- * @param cfg
- * @param value
+ * Load the cat index from EEPROM (at boot, after initStorage())
  */
-void setConfiguration(uint8_t cfg, uint16_t value);
+void initCats(void);
 
 /**
-    Get a cat slot
+    Get a cat slot (ID only, CRC is not stored)
  */
 void getCat(Cat* cat, uint8_t slot);
 
@@ -83,13 +73,24 @@ void getCat(Cat* cat, uint8_t slot);
 uint8_t saveCat(Cat* cat);
 
 /**
- * Locate a cat by it's CRC
+ * Locate a cat by it's ID, using the RAM index
  * @param cat cat structure
  * @param otherCrc Second CRC to be checked
  * @return 
  */
 bool catExists(Cat* cat, uint16_t* otherCrc);
 
+/**
+ * Locate a cat, recently opened cats are kept in RAM (CRC and ID hash) to
+ * tell when it last opened the door without reading EEPROM, other cats go
+ * through the RAM index
+ * @param cat cat structure
+ * @param otherCrc Second CRC to be checked
+ * @param window Time before the same cat can open again (ms)
+ * @return CAT_UNKNOWN, CAT_KNOWN or CAT_REPEAT
+ */
+uint8_t lookupCat(Cat* cat, uint16_t* otherCrc, ms_t window);
+
 /**
  * Clear all cats in the EEPROM memory
  */
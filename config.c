@@ -0,0 +1,52 @@
+/*
+ * File:   config.c
+ * Author: mdonze
+ *
+ * Created on 16 October 2026, 16:05
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+#include "storage.h"
+
+/**
+ * Bounds and default of a configuration
+ */
+typedef struct{
+    uint16_t min;   //Lowest value
+    uint16_t max;   //Highest value
+    uint16_t def;   //Value when never set
+}ConfigEntry;
+
+//Registry, indexed by configuration key
+static const ConfigEntry configs[CFG_COUNT] = {
+    {0, 1023, 512},     //LIGHT_CFG (ADC)
+    {0, 1023, 512},     //FLAP_POS_IDLE (ADC)
+    {0, 512, 30},       //FLAP_POS_MARGIN (ADC)
+    {0, 3600, 10},      //REOPEN_CFG (s)
+    {50, 2000, 500},    //LATCH_PULSE_CFG (ms)
+};
+
+uint16_t getConfiguration(uint8_t cfg)
+{
+    if(cfg >= CFG_COUNT){
+        return 0;
+    }
+    uint16_t v = storageGet(cfg);
+    if((v < configs[cfg].min) || (v > configs[cfg].max)){
+        v = configs[cfg].def;
+    }
+    return v;
+}
+
+bool setConfiguration(uint8_t cfg, uint16_t value)
+{
+    if((cfg >= CFG_COUNT) || (value < configs[cfg].min) ||
+            (value > configs[cfg].max)){
+        return false;
+    }
+    storageSet(cfg, value);
+    return true;
+}
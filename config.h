@@ -0,0 +1,67 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: config.h
+ * Author: mdonze
+ * Comments: Configuration registry, bounds and defaults of each setting
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef CONFIG_INCLUDED_H
+#define	CONFIG_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+//Configuration keys (less than STORE_KEYS)
+//Light threshold value
+#define LIGHT_CFG 0
+//Flap middle position
+#define FLAP_POS_IDLE 1
+//Flap middle position margin
+#define FLAP_POS_MARGIN 2
+//Time before the same cat can open again (s)
+#define REOPEN_CFG 3
+//Latch solenoid pulse width (ms)
+#define LATCH_PULSE_CFG 4
+//Number of configurations
+#define CFG_COUNT 5
+
+/**
+ * Gets a configuration (from RAM)
+ * @param cfg
+ * @return Value, default if never set or out of bounds
+ */
+uint16_t getConfiguration(uint8_t cfg);
+
+/**
+ * Sets a configuration, EEPROM is only written on change
+ * @param cfg
+ * @param value
+ * @return true if value is within bounds and saved
+ */
+bool setConfiguration(uint8_t cfg, uint16_t value);
+
+#endif	/* CONFIG_INCLUDED_H */
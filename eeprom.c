@@ -0,0 +1,112 @@
+/*
+ * File:   eeprom.c
+ * Author: mdonze
+ *
+ * Created on 16 October 2026, 10:12
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "eeprom.h"
+
+#define EEPROM_MASK (EEPROM_QUEUE-1)
+
+/**
+ * Pending EEPROM write
+ */
+typedef struct{
+    uint8_t addr;   //EEPROM address
+    uint8_t value;  //Byte to write
+}EEWrite;
+
+//Queued writes, the one at eeTail is being written
+static EEWrite eeQueue[EEPROM_QUEUE];
+//Next free entry (written by main)
+static volatile uint8_t eeHead = 0;
+//Oldest entry (written by ISR)
+static volatile uint8_t eeTail = 0;
+
+/**
+ * Start the write at queue tail. Interrupts must be disabled
+ */
+static void startWrite(void)
+{
+    EEADR = eeQueue[eeTail].addr;
+    EEDAT = eeQueue[eeTail].value;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.WREN = 1;
+    //Unlock sequence
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+    EECON1bits.WR = 1;
+    EECON1bits.WREN = 0;
+}
+
+void eepromWrite(uint8_t addr, uint8_t value)
+{
+    uint8_t next = (eeHead+1) & EEPROM_MASK;
+    //Wait for a free entry
+    while(next == eeTail){}
+    eeQueue[eeHead].addr = addr;
+    eeQueue[eeHead].value = value;
+    di();
+    bool idle = (eeHead == eeTail);
+    eeHead = next;
+    if(idle){
+        PIR2bits.EEIF = 0;
+        PIE2bits.EEIE = 1;
+        startWrite();
+    }
+    ei();
+}
+
+uint8_t eepromRead(uint8_t addr)
+{
+    //Last queued value wins, entries done meanwhile hold the same value
+    uint8_t tail = eeTail;
+    uint8_t i = eeHead;
+    while(i != tail){
+        i = (i-1) & EEPROM_MASK;
+        if(eeQueue[i].addr == addr){
+            return eeQueue[i].value;
+        }
+    }
+    for(;;){
+        //Let the write in progress finish, interrupts on so the ISR can
+        //start the next one
+        while(EECON1bits.WR){}
+        di();
+        //No write can start while EEADR is used
+        if(!EECON1bits.WR){
+            break;
+        }
+        ei();
+    }
+    EEADR = addr;
+    EECON1bits.EEPGD = 0;
+    EECON1bits.RD = 1;
+    uint8_t value = EEDAT;
+    ei();
+    return value;
+}
+
+bool eepromBusy(void)
+{
+    return eeHead != eeTail;
+}
+
+void eepromFlush(void)
+{
+    while(eeHead != eeTail){}
+}
+
+void eepromISR(void)
+{
+    eeTail = (eeTail+1) & EEPROM_MASK;
+    if(eeTail != eeHead){
+        startWrite();
+    }else{
+        PIE2bits.EEIE = 0;
+    }
+}
@@ -0,0 +1,72 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: eeprom.h
+ * Author: mdonze
+ * Comments: Data EEPROM with a background write queue
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef EEPROM_INCLUDED_H
+#define	EEPROM_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+//Number of pending writes (power of 2), one less can be queued. Holds a
+//cat slot (ID and check byte) and a journal record without waiting
+#define EEPROM_QUEUE 16
+
+/**
+ * Queue a byte write, only waits when the queue is full
+ * @param addr EEPROM address
+ * @param value Byte to write
+ */
+void eepromWrite(uint8_t addr, uint8_t value);
+
+/**
+ * Read a byte, including writes still in the queue
+ * @param addr EEPROM address
+ * @return Byte value
+ */
+uint8_t eepromRead(uint8_t addr);
+
+/**
+ * Are some writes pending?
+ * @return true if EEPROM is being written
+ */
+bool eepromBusy(void);
+
+/**
+ * Wait until all queued writes are done
+ */
+void eepromFlush(void);
+
+/**
+ * Write complete interrupt, starts the next queued write
+ */
+void eepromISR(void);
+
+#endif	/* EEPROM_INCLUDED_H */
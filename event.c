@@ -0,0 +1,136 @@
+/*
+ * File:   event.c
+ * Author: mdonze
+ *
+ * Created on 16 October 2026, 18:20
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "event.h"
+#include "serial.h"
+#include "interrupts.h"
+
+#define EVENT_MASK (EVENT_BACKLOG-1)
+//Length of an event frame (command and data)
+#define EVENT_FRAME (8+EVENT_DATA)
+//Passages are marked in the last data byte (MSB of the 10 bits idle point),
+//above any chip ID (country code up to 999)
+#define EVENT_PASSAGE 0xFC
+//Cat went out, marked in the MSB of the 10 bits amplitude
+#define EVENT_OUT 0x80
+
+/**
+ * Event kept in RAM, the sequence number gives the slot. The type is not
+ * stored, it is told by the data (see EVENT_PASSAGE)
+ */
+typedef struct{
+    ms_t time;                  //Time of the event
+    uint8_t data[EVENT_DATA];   //Event data
+}Event;
+
+static Event events[EVENT_BACKLOG];
+//Sequence number of the next event
+static uint16_t nextSeq = 0;
+//Number of events kept
+static uint8_t eventCount = 0;
+//Events are being replayed
+static bool replaying = false;
+//Next event to replay
+static uint16_t replaySeq = 0;
+
+/**
+ * Send an event frame
+ * @param seq Sequence number of the event
+ * @return false if it does not fit in TX buffer
+ */
+static bool sendEvent(uint16_t seq)
+{
+    if(txFree() < (EVENT_FRAME+4)){
+        return false;
+    }
+    Event* e = &events[seq & EVENT_MASK];
+    uint8_t type = EVENT_CAT;
+    uint8_t out = e->data[1];
+    uint8_t last = e->data[EVENT_DATA-1];
+    if(last >= EVENT_PASSAGE){
+        type = (out & EVENT_OUT) ? EVENT_EXIT : EVENT_ENTER;
+        out &= ~EVENT_OUT;
+        last &= ~EVENT_PASSAGE;
+    }
+    frameStart(EVENT_FRAME);
+    framePut('E');
+    framePutShort(seq);
+    framePutShort(e->time & 0xFFFF);
+    framePutShort(e->time >> 16);
+    framePut(type);
+    framePut(e->data[0]);
+    framePut(out);
+    for(uint8_t i=2;i<(EVENT_DATA-1);++i){
+        framePut(e->data[i]);
+    }
+    framePut(last);
+    frameEnd();
+    return true;
+}
+
+void postEvent(uint8_t type, uint8_t* data, ms_t time)
+{
+    Event* e = &events[nextSeq & EVENT_MASK];
+    e->time = time;
+    for(uint8_t i=0;i<EVENT_DATA;++i){
+        e->data[i] = data[i];
+    }
+    if(type != EVENT_CAT){
+        e->data[EVENT_DATA-1] |= EVENT_PASSAGE;
+        if(type == EVENT_EXIT){
+            e->data[1] |= EVENT_OUT;
+        }
+    }
+    if(eventCount < EVENT_BACKLOG){
+        ++eventCount;
+    }
+    if(replaying && (replaySeq == (uint16_t)(nextSeq-EVENT_BACKLOG))){
+        //Slot being replayed is overwritten, skip it
+        ++replaySeq;
+    }
+    //Replay sends it in order, host asks again if it is lost here
+    if(!replaying){
+        sendEvent(nextSeq);
+    }
+    ++nextSeq;
+}
+
+void replayEvents(uint16_t seq)
+{
+    if((uint16_t)(nextSeq-seq) > eventCount){
+        //Too old (or unknown), start with the oldest
+        seq = nextSeq-eventCount;
+    }
+    replaySeq = seq;
+    replaying = true;
+}
+
+void eventTask(void)
+{
+    while(replaying){
+        if(replaySeq == nextSeq){
+            if(txFree() < (6+4)){
+                return;
+            }
+            frameStart(6);
+            framePut('A');
+            framePut('V');
+            framePutShort(nextSeq);
+            //Events before the oldest one kept are lost
+            framePutShort(nextSeq-eventCount);
+            frameEnd();
+            replaying = false;
+        }else if(sendEvent(replaySeq)){
+            ++replaySeq;
+        }else{
+            return;
+        }
+    }
+}
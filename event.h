@@ -0,0 +1,84 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: event.h
+ * Author: mdonze
+ * Comments: Event backlog, events are kept in RAM with a sequence number
+ *           so the host can get the ones it missed
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef EVENT_INCLUDED_H
+#define	EVENT_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+#include "interrupts.h"
+
+//Number of events kept, must be a power of two (can be set by the build)
+#ifndef EVENT_BACKLOG
+#define EVENT_BACKLOG 8
+#endif
+#if (EVENT_BACKLOG < 2) || (EVENT_BACKLOG > 128) || ((EVENT_BACKLOG & (EVENT_BACKLOG-1)) != 0)
+#error "EVENT_BACKLOG must be a power of two between 2 and 128"
+#endif
+//Event data size
+#define EVENT_DATA 6
+
+//Event types
+//Known cat passed, data is the chip ID
+#define EVENT_CAT 'C'
+//Cat went in, data is swing amplitude, duration (ms) and flap idle point
+//(LSB first, amplitude and idle point are 10 bits), event time is the
+//start of the passage
+#define EVENT_ENTER 'I'
+//Cat went out, same data as EVENT_ENTER
+#define EVENT_EXIT 'O'
+
+/**
+ * Record an event, and send it to the host if nothing is being replayed.
+ * Event frame : 'E', seq, time (ms), type, data (LSB first)
+ * @param type Event type
+ * @param data Event data (EVENT_DATA bytes)
+ * @param time Time of the event (ms)
+ */
+void postEvent(uint8_t type, uint8_t* data, ms_t time);
+
+/**
+ * Send again every event kept since a sequence number, followed by
+ * 'A', 'V', next sequence number, oldest sequence number kept. Events
+ * older than the backlog are lost, replay starts with the oldest one kept,
+ * and the host sees the gap from the oldest sequence number.
+ * @param seq First sequence number wanted
+ */
+void replayEvents(uint16_t seq);
+
+/**
+ * Send events being replayed, as long as they fit in TX buffer
+ */
+void eventTask(void);
+
+#endif	/* EVENT_INCLUDED_H */
+
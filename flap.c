@@ -0,0 +1,187 @@
+/*
+ * File:   flap.c
+ * Author: mdonze
+ *
+ * Created on 17 October 2026, 11:05
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "flap.h"
+#include "interrupts.h"
+
+//Fixed point bits of the filtered values
+#define FLAP_FRAC 4
+//Low-pass filter strength (new sample weights 1/2^n)
+#define FLAP_FILTER_SHIFT 1
+//Idle drift tracking strength (1/2^n per step)
+#define FLAP_IDLE_SHIFT 4
+//Time between two idle tracking steps (ms)
+#define FLAP_IDLE_PERIOD 1000
+//Time the flap rests away from the idle point before it becomes the idle
+//point (ms), the potentiometer has moved
+#define FLAP_STUCK_TIME 30000
+
+//Last raw samples (median filter)
+static uint16_t samples[3];
+//Filtered position (fixed point)
+static uint16_t position = 0;
+//Idle point (fixed point)
+static uint16_t idlePoint = 0;
+//Configured idle point tracking started from
+static uint16_t idleSeed = 0xFFFF;
+//Last idle tracking step (ms, 16 LSBs)
+static uint16_t idleLast = 0;
+//Position the flap rests at, away from idle
+static uint16_t stillPos = 0;
+//Time the flap came to rest at stillPos (ms, 16 LSBs)
+static uint16_t stillSince = 0;
+//Side open now
+static uint8_t side = FLAP_CLOSED;
+//Passage in progress
+static bool moving = false;
+//Passage being measured
+static FlapPassage current;
+//Last time the flap was away from idle (ms, 16 LSBs)
+static uint16_t moveLast = 0;
+
+/**
+ * Median of the last 3 samples
+ * @return Median value
+ */
+static uint16_t median3(void)
+{
+    uint16_t a = samples[0];
+    uint16_t b = samples[1];
+    uint16_t c = samples[2];
+    if(a > b){
+        uint16_t t = a;
+        a = b;
+        b = t;
+    }
+    //a <= b
+    if(c < a){
+        return a;
+    }
+    if(c > b){
+        return b;
+    }
+    return c;
+}
+
+/**
+ * Distance between two positions
+ * @param a Position
+ * @param b Position
+ * @return Absolute difference
+ */
+static uint16_t distance(uint16_t a, uint16_t b)
+{
+    return (a > b) ? (a - b) : (b - a);
+}
+
+bool flapSample(uint16_t raw, uint16_t idle, uint16_t margin,
+        FlapPassage* passage)
+{
+    ms_t now = millis();
+    uint16_t now16 = (uint16_t)now;
+    if(idle != idleSeed){
+        //(Re)start from the configured idle point
+        idleSeed = idle;
+        idlePoint = idle << FLAP_FRAC;
+        position = raw << FLAP_FRAC;
+        samples[0] = raw;
+        samples[1] = raw;
+        samples[2] = raw;
+    }
+    samples[2] = samples[1];
+    samples[1] = samples[0];
+    samples[0] = raw;
+    //Median removes spikes, low-pass smooths what is left
+    uint16_t m = median3() << FLAP_FRAC;
+    if(m > position){
+        position += (m - position) >> FLAP_FILTER_SHIFT;
+    }else{
+        position -= (position - m) >> FLAP_FILTER_SHIFT;
+    }
+    uint16_t pos = position >> FLAP_FRAC;
+    uint16_t idl = idlePoint >> FLAP_FRAC;
+    uint16_t dev = distance(pos, idl);
+    if((dev <= (margin >> 1)) || (distance(pos, stillPos) > (margin >> 1))){
+        //Near idle, or still swinging
+        stillPos = pos;
+        stillSince = now16;
+    }else if((uint16_t)(now16 - stillSince) > FLAP_STUCK_TIME){
+        //Resting away from idle for too long, this is the idle point now,
+        //passage in progress is dropped
+        idlePoint = position;
+        idleLast = now16;
+        side = FLAP_CLOSED;
+        moving = false;
+        return false;
+    }
+    if(dev > margin){
+        side = (pos > idl) ? FLAP_INNER : FLAP_OUTER;
+    }else if(dev <= (margin >> 1)){
+        //Hysteresis, closed when well back to idle
+        side = FLAP_CLOSED;
+    }
+    if(side != FLAP_CLOSED){
+        if(!moving){
+            moving = true;
+            current.start = now;
+            current.amplitude = 0;
+        }
+        //Passage goes to the side of the largest swing, not the swing back
+        if(dev > current.amplitude){
+            current.amplitude = dev;
+            current.side = side;
+        }
+        moveLast = now16;
+        return false;
+    }
+    if(moving){
+        if((uint16_t)(now16 - moveLast) < FLAP_SETTLE_TIME){
+            return false;
+        }
+        moving = false;
+        current.duration = moveLast - (uint16_t)current.start;
+        *passage = current;
+        return true;
+    }
+    //Follow the potentiometer drift slowly, only while the flap rests near
+    //idle
+    if((dev <= (margin >> 1)) &&
+            ((uint16_t)(now16 - idleLast) >= FLAP_IDLE_PERIOD)){
+        idleLast = now16;
+        if(position > idlePoint){
+            idlePoint += ((position - idlePoint) >> FLAP_IDLE_SHIFT) | 1;
+        }else if(position < idlePoint){
+            idlePoint -= ((idlePoint - position) >> FLAP_IDLE_SHIFT) | 1;
+        }
+    }
+    return false;
+}
+
+uint16_t flapPosition(void)
+{
+    return position >> FLAP_FRAC;
+}
+
+uint16_t flapIdle(void)
+{
+    return idlePoint >> FLAP_FRAC;
+}
+
+uint8_t flapSide(void)
+{
+    return side;
+}
+
+bool flapStarting(void)
+{
+    return moving &&
+            ((uint16_t)((uint16_t)millis() - (uint16_t)current.start) <
+            FLAP_HOLD_TIME);
+}
@@ -0,0 +1,99 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: flap.h
+ * Author: mdonze
+ * Comments: Flap position filter and passage detector, fed with the
+ *           potentiometer samples
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef FLAP_INCLUDED_H
+#define	FLAP_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+#include "interrupts.h"
+
+//Flap side (from the idle point, more than the margin)
+#define FLAP_CLOSED 0
+//Flap open inner direction (cat goes in)
+#define FLAP_INNER 1
+//Flap open outer direction (cat goes out)
+#define FLAP_OUTER 2
+
+//Time back at idle ending a passage (ms), covers the flap swinging back
+#define FLAP_SETTLE_TIME 300
+//Time from the start of a passage the flap keeps the ADC (ms)
+#define FLAP_HOLD_TIME 500
+
+/**
+ * Passage of a cat
+ */
+typedef struct{
+    uint8_t side;           //FLAP_INNER (entered) or FLAP_OUTER (exited)
+    ms_t start;             //Time the flap left idle (ms)
+    uint16_t amplitude;     //Largest swing from idle (ADC)
+    uint16_t duration;      //Time the flap was away from idle (ms)
+}FlapPassage;
+
+/**
+ * Feed a potentiometer sample
+ * @param raw ADC value
+ * @param idle Configured idle point, tracking restarts from it when changed
+ * @param margin Swing from idle seen as open
+ * @param passage Filled when a passage ends
+ * @return true if a passage ended
+ */
+bool flapSample(uint16_t raw, uint16_t idle, uint16_t margin,
+        FlapPassage* passage);
+
+/**
+ * Filtered flap position
+ * @return ADC value
+ */
+uint16_t flapPosition(void);
+
+/**
+ * Idle point, following the potentiometer drift
+ * @return ADC value
+ */
+uint16_t flapIdle(void);
+
+/**
+ * Side the flap is open to now
+ * @return FLAP_CLOSED, FLAP_INNER or FLAP_OUTER
+ */
+uint8_t flapSide(void);
+
+/**
+ * Is a passage starting? RFID reads wait meanwhile so the flap is sampled
+ * at full rate, but not longer, a flap held open must not lock cats out
+ * @return true for FLAP_HOLD_TIME from the first swing
+ */
+bool flapStarting(void);
+
+#endif	/* FLAP_INCLUDED_H */
+
@@ -5,29 +5,96 @@
 #include "interrupts.h"
 #include "serial.h"
 #include "peripherials.h"
+#include "rfid.h"
+#include "eeprom.h"
+#include "buzzer.h"
+#include "adc.h"
 
 /******************************************************************************/
 /* Interrupt Routines                                                         */
 /******************************************************************************/
 static volatile ms_t millisValue=0;
+//RFID samples taken late (saturates)
+static volatile uint8_t lateSamples=0;
 
 void __interrupt () isr(void)
 {
+    //While the RFID reader samples, an entry services the sample or a
+    //single other source, so a sample only waits behind one source. The
+    //UART receiver is also serviced with a sample, its FIFO holds two bytes
+    bool sampling = TMR2IE;
+    bool sample = TMR2IF && sampling;
+    if(sample){
+        TMR2IF = 0;
+        rfidISR();
+    }
+    bool rx = RCIF;
+    if(rx){
+        serialRxISR();
+        rxBuffer.lastRx = (uint8_t)millisValue;
+    }
+    if(sampling && (sample || rx || TMR2IF)){
+        //Timer 2 is already due, next RFID sample is late
+        if(sample && TMR2IF && TMR2IE && (lateSamples != 0xFF)){
+            ++lateSamples;
+        }
+        return;
+    }
+    //The ADC interrupt is off while the reader owns the ADC
+    if(ADIF && ADIE){
+        ADIF = 0;
+        adcISR();
+    }
+    if(TMR0IF && TMR0IE){
+        TMR0IF = 0;
+        buzzerISR();
+        if(sampling){
+            return;
+        }
+    }
     if(TMR1IF && TMR1IE){
         TMR1H = TMR1_H_PRES;             // preset for timer1 MSB register
         TMR1L = TMR1_L_PRES;             // preset for timer1 LSB register        
         TMR1IF = 0;
         ++millisValue;
-    }else if(RCIF){
-        rxBuffer.buffer[rxBuffer.rIndex] = RCREG;
-        RCIF = 0;
-        if(++rxBuffer.rIndex == SER_BUFFER){
-            rxBuffer.rIndex = 0;
+        latchISR();
+        buzzerTickISR();
+        if(sampling){
+            return;
+        }
+    }
+    if(EEIF && EEIE){
+        EEIF = 0;
+        eepromISR();
+        if(sampling){
+            return;
+        }
+    }
+    if(TXIF && TXIE){
+        if(txBuffer.rIndex != txBuffer.uIndex){
+            TXREG = txBuffer.buffer[txBuffer.rIndex];
+            if(++txBuffer.rIndex == SER_TX_BUFFER){
+                txBuffer.rIndex = 0;
+            }
+        }
+        if(txBuffer.rIndex == txBuffer.uIndex){
+            //Nothing more to send
+            TXIE = 0;
         }
     }
 }
 
 ms_t millis(void)
 {
-    return millisValue;
+    ms_t t;
+    //Bytes are read one by one, the tick may come in between
+    do{
+        t = millisValue;
+    }while(t != millisValue);
+    return t;
+}
+
+uint8_t getLateSamples(void)
+{
+    return lateSamples;
 }
@@ -38,5 +38,12 @@ typedef uint32_t ms_t;
 
 ms_t millis(void);
 
+/**
+ * Number of RFID samples taken late since reset (saturates at 255)
+ * The entry taking a sample lasted until the next one was due
+ * @return Late samples
+ */
+uint8_t getLateSamples(void);
+
 #endif	/* INTERRUPTS_INCLUDED_H */
 
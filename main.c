@@ -7,9 +7,14 @@
 #include "peripherials.h"
 #include "user.h"          /* User funct/params, such as InitApp */
 #include "serial.h"
-#include <stdio.h>
 #include "rfid.h"
 #include "cat.h"
+#include "config.h"
+#include "event.h"
+#include "sched.h"
+#include "buzzer.h"
+#include "adc.h"
+#include "flap.h"
 
 /**
  * time to keep door open
@@ -27,7 +32,7 @@
  * Number of milliseconds
  * between flap potentiometer read
  */
-#define FLAP_POT_READ_PERIOD 200
+#define FLAP_POT_READ_PERIOD 20
 
 #endif
 
@@ -42,6 +47,49 @@
 #define MODE_CLEAR 5
 #define MODE_OPEN 6
 
+/**
+ * Time to learn a cat
+ */
+#define LEARN_TIME 30000
+
+/**
+ * Number of milliseconds
+ * between buttons read
+ */
+#define BUTTONS_PERIOD 10
+
+/**
+ * Number of milliseconds
+ * between mode (leds, night lock) updates
+ */
+#define MODE_PERIOD 50
+
+/**
+ * Main loop tasks, lower number runs first
+ */
+#define TASK_RELOCK 0
+#define TASK_LATCH 1
+#define TASK_RFID 2
+#define TASK_BUTTONS 3
+#define TASK_MODE 4
+#define TASK_FLAP 5
+#define TASK_LIGHT 6
+#define TASK_COMM 7
+#define TASK_LEARN 8
+
+#if SCHED_TASKS <= TASK_LEARN
+#error "SCHED_TASKS too small for the main loop tasks"
+#endif
+
+/**
+ * Status fields the host can subscribe to
+ */
+#define PUSH_MODE 0x1
+#define PUSH_LIGHT 0x2
+#define PUSH_POS 0x4
+#define PUSH_BITS 0x8
+#define PUSH_ALL 0xF
+
 /**
  * Defines for button handling
  */
@@ -49,39 +97,55 @@
 #define RED_PRESS 2
 #define BOTH_PRESS 3
 
-#define CMD_STATE_IDLE 0
-#define CMD_STATE_STAT 1
-#define CMD_STATE_MODE 2 
-#define CMD_STATE_SETTING 3
-
 //Operation mode
 static uint8_t opMode = MODE_NORMAL;    
 //Is the out locked?
 static bool outLocked = false;
 //Is the in locked
 static bool inLocked = false;
+//Door can be opened by a known cat
+static bool openAllowed = false;
 //Light sensor value
 static uint16_t light = 0;
-//Light sensor threshold
-static uint16_t lightThd = 0;    
 #ifdef FLAP_POT
-//Flap position
+//Flap position (filtered)
 static uint16_t flapPos = 0;
-//Flap position tolerance
-static uint16_t flapPosTol = 30;
-//Flap position IDLE
-static uint16_t flapPosIdle = 512;
-//Flap open inner 
-static bool flapInner = false;
-//Flap open outer
-static bool flapOuter = false;
 #endif
+//Status fields pushed to host (0 if not subscribed)
+static uint8_t pushMask = 0;
+//Smallest light change pushed
+static uint16_t pushLightDelta = 0;
+//Smallest flap position change pushed
+static uint16_t pushPosDelta = 0;
+//Fields to push even if they did not change
+static uint8_t pushForce = 0;
+//Values last pushed
+static uint8_t pushedMode = 0;
+static uint16_t pushedLight = 0;
+static uint16_t pushedPos = 0;
+static uint16_t pushedBits = 0;
+
+void learnTimeoutTask(void);
+
+/**
+ * Can a known cat open the door in a mode?
+ * @param mode Operating mode
+ * @return true if RFID reads open the door
+ */
+static bool modeOpens(uint8_t mode)
+{
+    return (mode == MODE_NORMAL) || (mode == MODE_VET) ||
+            (mode == MODE_NIGHT);
+}
 
 /**
  * Switch flap operating mode
  * @param mode
  */
 void switchMode(uint8_t mode){    
+    //Latches are set again below
+    schedCancel(TASK_RELOCK);
+    schedCancel(TASK_LEARN);
     switch(mode){
         case MODE_NIGHT:
         case MODE_NORMAL:
@@ -109,7 +173,12 @@ void switchMode(uint8_t mode){
             mode = MODE_NORMAL;
             break;
     }
+    if(mode == MODE_LEARN){
+        schedAfter(TASK_LEARN, LEARN_TIME);
+    }
     opMode = mode;
+    //RFID task must not wait for the mode task to see the new mode
+    openAllowed = modeOpens(mode);
 }
 
 /**
@@ -169,35 +238,12 @@ uint8_t handleButtons(ms_t *time){
 }
 
 /**
- * Learn a new cat and save it to eeprom
+ * Learn time is over
  */
-void learnCat(void)
+void learnTimeoutTask(void)
 {
-    uint8_t r = 0;
-    uint16_t crcRead;    
-    ms_t t = millis();
-    ms_t now = 0;
-    uint16_t i =0;
-    Cat cat;
-    do{                
-        r = readRFID(&cat.id[0], 6, &cat.crc, &crcRead);
-        if((r ==0) && (cat.crc == crcRead) && (crcRead != 0)){        
-            uint8_t slot = saveCat(&cat);
-            if(slot>0){
-                //Saved successfully
-                beep();
-                break;
-            }
-        }
-        ++i;
-        if(i>9){
-            i = 0;
-            GREEN_LED = !GREEN_LED;
-        }
-        __delay_ms(20);
-        now = millis();
-    }while((now-t)<30000);
-    GREEN_LED = 0;
+    playTone(TONE_ERROR);
+    switchMode(MODE_NORMAL);
 }
 
 /**
@@ -213,10 +259,10 @@ uint16_t buildStatusBits(){
     if(inLocked){ ret = 0x1; }
     if(outLocked){ ret |= 0x2; }
 #ifdef FLAP_POT
-    if(flapInner){
+    if(flapSide() == FLAP_INNER){
         //Flap is open inner direction
         ret |= 0x4;
-    }else if(flapOuter){
+    }else if(flapSide() == FLAP_OUTER){
         //Flap is open closed direction
         ret |= 0x8;
     }
@@ -225,274 +271,535 @@ uint16_t buildStatusBits(){
 }
 
 void printStatus(){
-    putch('A');
-    putch('M');
-    putch(opMode);
-    putch('L');
-    putShort(light);
-    putch('P');
+    frameStart(12);
+    framePut('A');
+    framePut('M');
+    framePut(opMode);
+    framePut('L');
+    framePutShort(light);
+    framePut('P');
 #ifdef FLAP_POT
-    putShort(flapPos);
+    framePutShort(flapPos);
 #else
-    putShort(0);
+    framePutShort(0);
 #endif            
-    putch('S');
-    putShort(buildStatusBits());
-    putch('\n');
+    framePut('S');
+    framePutShort(buildStatusBits());
+    frameEnd();
 }
 
 /**
- * Handle all serial communication with external
+ * Tell if a value moved more than a threshold
+ * @param a
+ * @param b
+ * @param delta Threshold
+ * @return true if |a-b| >= delta
  */
-void handleSerial(){
-    uint8_t b = 0;    
-    //Do we received a command?
-    if(byteAvail()){
-        uint8_t c = 0;
-        if(getByte(&c) == 0){
-            switch(c){
-                case 'S':
-                    //Get status
-                    printStatus();
-                    break;
-                case 'C':
-                    //Change/read a configuration
-                    //read/write?
-                    if(getByte(&b) == 0){                
-                        uint8_t index = 0;
-                        //Get parameter index
-                        if(getByte(&index) == 0){
-                            if(b == 'S'){
-                                //Set the configuration                    
-                                uint16_t value = 0;
-                                if(getShort(&value) == 0){
-                                    setConfiguration(index, value);
-                                    putch('A');
-                                    putch('C');
-                                    putch(index);
-                                    putch('V');
-                                    putShort(value);
-                                    putch('\n');
-                                    switch(index){
-                                        case LIGHT_CFG:
-                                            lightThd = value;
-                                            break;
-                                        case FLAP_POS_IDLE:
-                                            flapPosIdle = value;
-                                            break;
-                                        case FLAP_POS_MARGIN:
-                                            flapPosTol = value;
-                                            break;
-                                        default:
-                                            ;
-                                    }
-                                }
-                            }else{
-                                //Read the configuration
-                                putch('A');
-                                putch('C');
-                                putch(index);
-                                putch('V');
-                                putShort(getConfiguration(index));
-                                putch('\n');
-                            }
-                        }else{
-                            printf("AE\n");
-                        }
-                    }
-                    break;
-                case 'M':
-                    //Change mode
-                    if(getByte(&b) == 0){
-                        if(b<=MODE_OPEN){
-                            switchMode(b);
-                            putch('A');
-                            putch('M');
-                            putch(opMode);
-                            putch('\n');            
-                        }
-                    }
-                    break;
-                default:
-                    //Not handled, ignore it
-                    return;
-            }
-        }
-    }
+static bool movedBy(uint16_t a, uint16_t b, uint16_t delta)
+{
+    uint16_t d = (a > b) ? (a-b) : (b-a);
+    return (d != 0) && (d >= delta);
 }
 
 /**
- * Send cat ID by serial
- * @param c
+ * Push subscribed status fields that changed
+ * Frame : 'P', fields mask, then mode, light, flap position and status bits
+ * (only the fields in mask)
  */
-void printCat(Cat* c)
+void pushStatus(void)
 {
-    putch('E');
-    for(uint8_t i=0;i<6;++i){
-        putch(c->id[i]);
+    if(pushMask == 0){
+        return;
     }
-    putch('\n');
+#ifdef FLAP_POT
+    uint16_t pos = flapPos;
+#else
+    uint16_t pos = 0;
+#endif
+    uint16_t bits = buildStatusBits();
+    uint8_t changed = pushForce;
+    if(pushedMode != opMode){ changed |= PUSH_MODE; }
+    if(movedBy(light, pushedLight, pushLightDelta)){ changed |= PUSH_LIGHT; }
+    if(movedBy(pos, pushedPos, pushPosDelta)){ changed |= PUSH_POS; }
+    if(pushedBits != bits){ changed |= PUSH_BITS; }
+    changed &= pushMask;
+    if(changed == 0){
+        return;
+    }
+    uint8_t len = 2;
+    if(changed & PUSH_MODE){ len += 1; }
+    if(changed & PUSH_LIGHT){ len += 2; }
+    if(changed & PUSH_POS){ len += 2; }
+    if(changed & PUSH_BITS){ len += 2; }
+    if(txFree() < (len+4)){
+        //Pushed later, values are still different
+        return;
+    }
+    frameStart(len);
+    framePut('P');
+    framePut(changed);
+    if(changed & PUSH_MODE){
+        framePut(opMode);
+        pushedMode = opMode;
+    }
+    if(changed & PUSH_LIGHT){
+        framePutShort(light);
+        pushedLight = light;
+    }
+    if(changed & PUSH_POS){
+        framePutShort(pos);
+        pushedPos = pos;
+    }
+    if(changed & PUSH_BITS){
+        framePutShort(bits);
+        pushedBits = bits;
+    }
+    frameEnd();
+    pushForce = 0;
 }
 
-/******************************************************************************/
-/* Main Program                                                               */
-/******************************************************************************/
-void main(void)
+/**
+ * Subscribe to status changes, every subscribed field is pushed once
+ * @param mask Fields pushed (0 to stop)
+ * @param lightDelta Smallest light change pushed
+ * @param posDelta Smallest flap position change pushed
+ */
+void subscribeStatus(uint8_t mask, uint16_t lightDelta, uint16_t posDelta)
 {
-    uint8_t r = 0;
-    Cat c;
-    uint16_t crcRead;
-    ms_t btnPress = 0;    
-    /* Initialize I/O and Peripherals for application */
-    InitApp();
-    lightThd = getConfiguration(LIGHT_CFG);    
-    if(lightThd>1023){
-        lightThd = 512;
+    pushMask = mask & PUSH_ALL;
+    pushLightDelta = lightDelta;
+    pushPosDelta = posDelta;
+    pushForce = pushMask;
+}
+
+/**
+ * Send a configuration
+ * @param index Configuration index
+ */
+void printConfig(uint8_t index)
+{
+    frameStart(6);
+    framePut('A');
+    framePut('C');
+    framePut(index);
+    framePut('V');
+    framePutShort(getConfiguration(index));
+    frameEnd();
+}
+
+/**
+ * Send all configurations in one answer
+ */
+void printConfigs(void)
+{
+    frameStart(3+CFG_COUNT*2);
+    framePut('A');
+    framePut('B');
+    framePut(CFG_COUNT);
+    for(uint8_t i=0;i<CFG_COUNT;++i){
+        framePutShort(getConfiguration(i));
     }
-    switchMode(MODE_NORMAL);
-    ms_t lastLightRead = millis();
-#ifdef FLAP_POT
-    ms_t lastFlapRead = lastLightRead;
-    flapPosIdle = getConfiguration(FLAP_POS_IDLE);
-    flapPosTol = getConfiguration(FLAP_POS_MARGIN);
-#endif
-    while(1)
-    {   
-        ms_t ms = millis();
-        if((ms-lastLightRead)>LIGHT_READ_PERIOD){
-            light = getLightSensor();           
-            lastLightRead = ms;
-        }
-#ifdef FLAP_POT
-        if((ms-lastFlapRead)>FLAP_POT_READ_PERIOD){
-            flapPos = getFlapPosition();
-            bool doUpdate = false;
-            if(flapPos > (flapPosIdle+flapPosTol)){
-                //Flap is open inner direction (open)
-                if(!flapInner){
-                    flapInner = true;
-                    flapOuter = false;
-                    doUpdate = true;
-                }
-            }else if(flapPos < (flapPosIdle-flapPosTol)){
-                //Flap is open outer direction
-                if(!flapOuter){
-                    flapOuter = true;
-                    flapInner = false;
-                    doUpdate = true;
-                }
-            }else{
-                doUpdate = flapInner | flapOuter;
-                flapOuter = false;
-                flapInner = false;
+    frameEnd();
+}
+
+/**
+ * Handle a configuration command
+ * 'S' index value : set one configuration
+ * 'R' index : read one configuration
+ * 'B' : read all configurations
+ * 'W' count values : set the first count configurations
+ * Set commands answer with the values kept (bad values are ignored)
+ * @param len Length of the frame, configuration command is its second byte
+ * @return false if arguments are bad
+ */
+bool handleConfig(uint8_t len)
+{
+    switch(getFrameByte(1)){
+        case 'B':
+            printConfigs();
+            break;
+        case 'W':
+            //Number of values, then values
+            if((len < 3) || (len != (3+getFrameByte(2)*2))){
+                return false;
             }
-            if(doUpdate){
-                printStatus();
+            for(uint8_t i=0;i<getFrameByte(2);++i){
+                setConfiguration(i, getFrameByte(3+i*2) |
+                        (getFrameByte(4+i*2)<<8));
+            }
+            printConfigs();
+            break;
+        case 'S':
+            if(len != 5){
+                return false;
             }
-            lastFlapRead = ms;
+            setConfiguration(getFrameByte(2),
+                    getFrameByte(3) | (getFrameByte(4)<<8));
+            printConfig(getFrameByte(2));
+            break;
+        case 'R':
+            if(len != 3){
+                return false;
+            }
+            printConfig(getFrameByte(2));
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Send serial link error counters, worst main loop latency, quality of
+ * the last RFID frame (weak boundaries, margin, repaired) and late RFID
+ * samples
+ */
+void printDiagnostics(void)
+{
+    RFIDQuality q;
+    getRFIDQuality(&q);
+    frameStart(13);
+    framePut('A');
+    framePut('D');
+    framePut(rxBuffer.overruns);
+    framePut(rxBuffer.framingErrors);
+    framePut(rxBuffer.dropped);
+    framePutShort(getTxDropped());
+    framePutShort(schedMaxLate());
+    framePut(q.weakBounds);
+    framePut(q.margin);
+    framePut(q.repaired);
+    framePut(getLateSamples());
+    frameEnd();
+}
+
+/**
+ * Handle all serial communication with external
+ */
+void handleSerial(){
+    uint8_t r;
+    serialTask();
+    eventTask();
+    //Handle every frame received, as long as answers fit in TX buffer
+    while((txFree() >= (FRAME_MAX+4)) && ((r = pollFrame()) != FRAME_NONE)){
+        if(r != FRAME_OK){
+            frameNack(r, 0);
+            continue;
         }
-#endif
-        bool doOpen = false;
-        switch(opMode){
-            case MODE_NORMAL:             
-                doOpen = true;
-                RED_LED = 0;
-                GREEN_LED = 0;
-                break;
-            case MODE_VET:
-                GREEN_LED = 0;
-                //Blink red led
-                RED_LED = ((ms>>9) & 0x1);
-                doOpen = true;
+        uint8_t len = getFrameLength();
+        uint8_t cmd = getFrameByte(0);
+        switch(cmd){
+            case 'S':
+                //Get status
+                printStatus();
                 break;
-            case MODE_CLOSED:
-                doOpen = false;
-                //Blink both leds
-                RED_LED = ((ms>>9) & 0x1);;
-                GREEN_LED = ((ms>>9) & 0x1);
+            case 'C':
+                //Change/read configurations
+                if((len < 2) || !handleConfig(len)){
+                    frameNack(FRAME_BAD_ARG, cmd);
+                }
                 break;
-            case MODE_LEARN:
-                learnCat();
-                switchMode(MODE_NORMAL);
+            case 'M':
+                //Change mode
+                if((len == 2) && (getFrameByte(1)<=MODE_OPEN)){
+                    switchMode(getFrameByte(1));
+                    frameStart(3);
+                    framePut('A');
+                    framePut('M');
+                    framePut(opMode);
+                    frameEnd();
+                }else{
+                    frameNack(FRAME_BAD_ARG, cmd);
+                }
                 break;
-            case MODE_CLEAR:
-                clearCats();
-                switchMode(MODE_NORMAL);
+            case 'U':
+                //Change baud rate, answered at the current one
+                if((len == 2) && (getFrameByte(1) < BAUD_COUNT)){
+                    frameStart(3);
+                    framePut('A');
+                    framePut('U');
+                    framePut(getFrameByte(1));
+                    frameEnd();
+                    serialSetBaud(getFrameByte(1));
+                }else{
+                    frameNack(FRAME_BAD_ARG, cmd);
+                }
                 break;
-            case MODE_OPEN:
-                RED_LED = 1;
-                GREEN_LED = 1;
-                doOpen = false;
+            case 'P':
+                //Subscribe to status changes
+                if(len == 6){
+                    subscribeStatus(getFrameByte(1),
+                            getFrameByte(2) | (getFrameByte(3)<<8),
+                            getFrameByte(4) | (getFrameByte(5)<<8));
+                    frameStart(3);
+                    framePut('A');
+                    framePut('P');
+                    framePut(pushMask);
+                    frameEnd();
+                }else{
+                    frameNack(FRAME_BAD_ARG, cmd);
+                }
                 break;
-            case MODE_NIGHT:
-                //Tests if light is not enough
-                //More is darker
-                if((light>lightThd) && !outLocked){
-                    outLocked = lockRedLatch(true);
-                    lockGreenLatch(true);
-                }else if((light<(lightThd-5)) && outLocked){
-                    outLocked = lockRedLatch(false);
-                    lockGreenLatch(true);
+            case 'V':
+                //Events since a sequence number
+                if(len == 3){
+                    replayEvents(getFrameByte(1) | (getFrameByte(2)<<8));
+                }else{
+                    frameNack(FRAME_BAD_ARG, cmd);
                 }
-                GREEN_LED = outLocked;
-                RED_LED = 1;
-                doOpen = true;
+                break;
+            case 'D':
+                //Serial link, main loop and RFID diagnostics
+                printDiagnostics();
                 break;
             default:
-                switchMode(MODE_NORMAL);
-                doOpen = false;
+                frameNack(FRAME_BAD_CMD, cmd);
                 break;
         }
-        //If open is allowed
-        if(doOpen){
-            //Read RFID chip
-            r = readRFID(&c.id[0], 6, &c.crc, &crcRead);
-            if(r == 0 && catExists(&c, &crcRead)){
-                //Read ok and found in EEPROM
-                beep();
-                inLocked = lockGreenLatch(false);
-                printCat(&c);
-                __delay_ms(OPEN_TIME);
-                inLocked = lockGreenLatch(true);                
-            }
-            c.crc = 0x0;
-            //Relax
-            __delay_ms(20);
+    }
+}
+
+/**
+ * Put the in latch back after a cat passed
+ */
+void relockTask(void)
+{
+    inLocked = lockGreenLatch(true);
+}
+
+/**
+ * Poll the RFID reader, opens the door for known cats or saves the cat in
+ * learn mode
+ */
+void rfidTask(void)
+{
+    Cat c;
+    uint16_t crcRead;
+    if(!openAllowed && (opMode != MODE_LEARN)){
+        return;
+    }
+    //L293 drives the latches
+    if(latchBusy()){
+        return;
+    }
+#ifdef FLAP_POT
+    //Passage starting, ADC samples the flap at full rate
+    if(flapStarting()){
+        return;
+    }
+#endif
+    //Read RFID chip (in background)
+    if(pollRFID(&c.id[0], 6, &c.crc, &crcRead) != 0){
+        return;
+    }
+    if(opMode == MODE_LEARN){
+        if((c.crc == crcRead) && (crcRead != 0) && (saveCat(&c) > 0)){
+            //Saved successfully
+            playTone(TONE_DOUBLE);
+            switchMode(MODE_NORMAL);
         }
-        
-        //Handle buttons modes
-        switch(handleButtons(&btnPress)){
-            case GREEN_PRESS :
-                if(btnPress>10000){
-                    switchMode(MODE_LEARN);
-                }
-                break;
-            case RED_PRESS :
-                if(btnPress>5000){
-                    if(opMode == MODE_VET){
-                        switchMode(MODE_NORMAL);
-                    }else{
-                        switchMode(MODE_VET);
-                    }
-                }else if(btnPress<2000){
-                    if(opMode == MODE_NIGHT){
-                        switchMode(MODE_NORMAL);
-                    }else{
-                        switchMode(MODE_NIGHT);                        
-                    }
+    }else if(lookupCat(&c, &crcRead,
+            (ms_t)getConfiguration(REOPEN_CFG)*1000) == CAT_KNOWN){
+        //Read ok, known cat not opened recently
+        postEvent(EVENT_CAT, c.id, millis());
+        if(!schedPending(TASK_RELOCK)){
+            playTone(TONE_BEEP);
+            inLocked = lockGreenLatch(false);
+        }
+        //Another cat keeps the door open
+        schedAfter(TASK_RELOCK, OPEN_TIME);
+    }
+}
+
+/**
+ * Pulse latches which have to change
+ */
+void latchesTask(void)
+{
+    latchTask(getConfiguration(LATCH_PULSE_CFG));
+}
+
+/**
+ * Read the light sensor
+ */
+void lightTask(void)
+{
+    //Conversion is queued, result is read on next run
+    if(!adcResult(ADC_LIGHT, &light)){
+        schedDelay(TASK_LIGHT, 1);
+    }
+}
+
+#ifdef FLAP_POT
+/**
+ * Sample the flap position, and look for cat passages
+ */
+void flapTask(void)
+{
+    uint16_t raw;
+    FlapPassage p;
+    //Conversion queued on last run is read, unless RFID held the ADC
+    if(!adcResult(ADC_FLAP, &raw)){
+        schedDelay(TASK_FLAP, 1);
+        return;
+    }
+    //Next conversion is queued now, so samples are one period apart
+    adcQueue(ADC_FLAP);
+    if(flapSample(raw, getConfiguration(FLAP_POS_IDLE),
+            getConfiguration(FLAP_POS_MARGIN), &p)){
+        uint16_t idle = flapIdle();
+        uint8_t data[EVENT_DATA] = {p.amplitude & 0xFF, p.amplitude >> 8,
+                p.duration & 0xFF, p.duration >> 8, idle & 0xFF, idle >> 8};
+        //Event time is the start of the passage
+        postEvent((p.side == FLAP_INNER) ? EVENT_ENTER : EVENT_EXIT, data,
+                p.start);
+    }
+    flapPos = flapPosition();
+}
+#endif
+
+/**
+ * Update leds and latches for the operating mode
+ */
+void modeTask(void)
+{
+    ms_t ms = millis();
+    uint16_t lightThd = getConfiguration(LIGHT_CFG);
+    switch(opMode){
+        case MODE_NORMAL:             
+            RED_LED = 0;
+            GREEN_LED = 0;
+            break;
+        case MODE_VET:
+            GREEN_LED = 0;
+            //Blink red led
+            RED_LED = ((ms>>9) & 0x1);
+            break;
+        case MODE_CLOSED:
+            //Blink both leds
+            RED_LED = ((ms>>9) & 0x1);;
+            GREEN_LED = ((ms>>9) & 0x1);
+            break;
+        case MODE_LEARN:
+            //Blink green led while learning
+            RED_LED = 0;
+            GREEN_LED = ((ms>>8) & 0x1);
+            break;
+        case MODE_CLEAR:
+            clearCats();
+            playTone(TONE_CLEAR);
+            switchMode(MODE_NORMAL);
+            break;
+        case MODE_OPEN:
+            RED_LED = 1;
+            GREEN_LED = 1;
+            break;
+        case MODE_NIGHT:
+            //Tests if light is not enough
+            //More is darker, latches are left alone while a cat passes
+            if(schedPending(TASK_RELOCK)){
+                //Wait for relock
+            }else if((light>lightThd) && !outLocked){
+                outLocked = lockRedLatch(true);
+                lockGreenLatch(true);
+            }else if((light<(lightThd-5)) && outLocked){
+                outLocked = lockRedLatch(false);
+                lockGreenLatch(true);
+            }
+            GREEN_LED = outLocked;
+            RED_LED = 1;
+            break;
+        default:
+            switchMode(MODE_NORMAL);
+            break;
+    }
+    openAllowed = modeOpens(opMode);
+}
+
+/**
+ * Handle buttons modes
+ */
+void buttonsTask(void)
+{
+    ms_t btnPress = 0;
+    switch(handleButtons(&btnPress)){
+        case GREEN_PRESS :
+            if(btnPress>10000){
+                switchMode(MODE_LEARN);
+            }
+            break;
+        case RED_PRESS :
+            if(btnPress>5000){
+                if(opMode == MODE_VET){
+                    switchMode(MODE_NORMAL);
+                }else{
+                    switchMode(MODE_VET);
                 }
-                break;
-            case BOTH_PRESS :
-                /*if((btnPress>2000) && (btnPress<30000)){
-                    //TODO: Extended mode, to be implemented
-                }else*/ if(btnPress>30000){
-                    switchMode(MODE_CLEAR);                    
+            }else if(btnPress<2000){
+                if(opMode == MODE_NIGHT){
+                    switchMode(MODE_NORMAL);
+                }else{
+                    switchMode(MODE_NIGHT);                        
                 }
-                break;              
-        }
-        
-        //Handle serial comm
-        handleSerial();
+            }
+            break;
+        case BOTH_PRESS :
+            /*if((btnPress>2000) && (btnPress<30000)){
+                //TODO: Extended mode, to be implemented
+            }else*/ if(btnPress>30000){
+                switchMode(MODE_CLEAR);                    
+            }
+            break;              
     }
 }
 
+/**
+ * Handle serial comm
+ */
+void commTask(void)
+{
+    handleSerial();
+    pushStatus();
+}
+
+/**
+ * Main loop tasks, by task number
+ */
+const Task schedTasks[SCHED_TASKS] = {
+    {relockTask, SCHED_ONCE},               //TASK_RELOCK
+    {latchesTask, 0},                       //TASK_LATCH
+    {rfidTask, 0},                          //TASK_RFID
+    {buttonsTask, BUTTONS_PERIOD},          //TASK_BUTTONS
+    {modeTask, MODE_PERIOD},                //TASK_MODE
+#ifdef FLAP_POT
+    {flapTask, FLAP_POT_READ_PERIOD},       //TASK_FLAP
+#else
+    {0, SCHED_ONCE},                        //TASK_FLAP (not used)
+#endif
+    {lightTask, LIGHT_READ_PERIOD},         //TASK_LIGHT
+    {commTask, 0},                          //TASK_COMM
+    {learnTimeoutTask, SCHED_ONCE},         //TASK_LEARN
+};
+
+/******************************************************************************/
+/* Main Program                                                               */
+/******************************************************************************/
+void main(void)
+{
+    /* Initialize I/O and Peripherals for application */
+    InitApp();
+    switchMode(MODE_NORMAL);
+    schedStart(TASK_LATCH);
+    schedStart(TASK_RFID);
+    schedStart(TASK_BUTTONS);
+    schedStart(TASK_MODE);
+#ifdef FLAP_POT
+    schedStart(TASK_FLAP);
+#endif
+    schedStart(TASK_LIGHT);
+    schedStart(TASK_COMM);
+    while(1)
+    {   
+        schedRun();
+    }
+}
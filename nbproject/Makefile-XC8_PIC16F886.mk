@@ -57,17 +57,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c
+SOURCEFILES_QUOTED_IF_SPACED=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c eeprom.c storage.c config.c crc.c event.c sched.c buzzer.c adc.c flap.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1
-POSSIBLE_DEPFILES=${OBJECTDIR}/configuration_bits.p1.d ${OBJECTDIR}/interrupts.p1.d ${OBJECTDIR}/main.p1.d ${OBJECTDIR}/user.p1.d ${OBJECTDIR}/serial.p1.d ${OBJECTDIR}/rfid.p1.d ${OBJECTDIR}/peripherials.p1.d ${OBJECTDIR}/cat.p1.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1 ${OBJECTDIR}/eeprom.p1 ${OBJECTDIR}/storage.p1 ${OBJECTDIR}/config.p1 ${OBJECTDIR}/crc.p1 ${OBJECTDIR}/event.p1 ${OBJECTDIR}/sched.p1 ${OBJECTDIR}/buzzer.p1 ${OBJECTDIR}/adc.p1 ${OBJECTDIR}/flap.p1
+POSSIBLE_DEPFILES=${OBJECTDIR}/configuration_bits.p1.d ${OBJECTDIR}/interrupts.p1.d ${OBJECTDIR}/main.p1.d ${OBJECTDIR}/user.p1.d ${OBJECTDIR}/serial.p1.d ${OBJECTDIR}/rfid.p1.d ${OBJECTDIR}/peripherials.p1.d ${OBJECTDIR}/cat.p1.d ${OBJECTDIR}/eeprom.p1.d ${OBJECTDIR}/storage.p1.d ${OBJECTDIR}/config.p1.d ${OBJECTDIR}/crc.p1.d ${OBJECTDIR}/event.p1.d ${OBJECTDIR}/sched.p1.d ${OBJECTDIR}/buzzer.p1.d ${OBJECTDIR}/adc.p1.d ${OBJECTDIR}/flap.p1.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1
+OBJECTFILES=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1 ${OBJECTDIR}/eeprom.p1 ${OBJECTDIR}/storage.p1 ${OBJECTDIR}/config.p1 ${OBJECTDIR}/crc.p1 ${OBJECTDIR}/event.p1 ${OBJECTDIR}/sched.p1 ${OBJECTDIR}/buzzer.p1 ${OBJECTDIR}/adc.p1 ${OBJECTDIR}/flap.p1
 
 # Source Files
-SOURCEFILES=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c
+SOURCEFILES=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c eeprom.c storage.c config.c crc.c event.c sched.c buzzer.c adc.c flap.c
 
 
 CFLAGS=
@@ -157,6 +157,78 @@ ${OBJECTDIR}/cat.p1: cat.c  nbproject/Makefile-${CND_CONF}.mk
 	@-${MV} ${OBJECTDIR}/cat.d ${OBJECTDIR}/cat.p1.d 
 	@${FIXDEPS} ${OBJECTDIR}/cat.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
 	
+${OBJECTDIR}/flap.p1: flap.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flap.p1.d 
+	@${RM} ${OBJECTDIR}/flap.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/flap.p1 flap.c 
+	@-${MV} ${OBJECTDIR}/flap.d ${OBJECTDIR}/flap.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/flap.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/adc.p1: adc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/adc.p1.d 
+	@${RM} ${OBJECTDIR}/adc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/adc.p1 adc.c 
+	@-${MV} ${OBJECTDIR}/adc.d ${OBJECTDIR}/adc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/adc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/buzzer.p1: buzzer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/buzzer.p1.d 
+	@${RM} ${OBJECTDIR}/buzzer.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/buzzer.p1 buzzer.c 
+	@-${MV} ${OBJECTDIR}/buzzer.d ${OBJECTDIR}/buzzer.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/buzzer.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/sched.p1: sched.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sched.p1.d 
+	@${RM} ${OBJECTDIR}/sched.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/sched.p1 sched.c 
+	@-${MV} ${OBJECTDIR}/sched.d ${OBJECTDIR}/sched.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/sched.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/event.p1: event.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/event.p1.d 
+	@${RM} ${OBJECTDIR}/event.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/event.p1 event.c 
+	@-${MV} ${OBJECTDIR}/event.d ${OBJECTDIR}/event.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/event.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/crc.p1: crc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/crc.p1.d 
+	@${RM} ${OBJECTDIR}/crc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/crc.p1 crc.c 
+	@-${MV} ${OBJECTDIR}/crc.d ${OBJECTDIR}/crc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/crc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/config.p1: config.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/config.p1.d 
+	@${RM} ${OBJECTDIR}/config.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/config.p1 config.c 
+	@-${MV} ${OBJECTDIR}/config.d ${OBJECTDIR}/config.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/config.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/storage.p1: storage.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/storage.p1.d 
+	@${RM} ${OBJECTDIR}/storage.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/storage.p1 storage.c 
+	@-${MV} ${OBJECTDIR}/storage.d ${OBJECTDIR}/storage.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/storage.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/eeprom.p1: eeprom.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/eeprom.p1.d 
+	@${RM} ${OBJECTDIR}/eeprom.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/eeprom.p1 eeprom.c 
+	@-${MV} ${OBJECTDIR}/eeprom.d ${OBJECTDIR}/eeprom.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/eeprom.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
 else
 ${OBJECTDIR}/configuration_bits.p1: configuration_bits.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}" 
@@ -222,6 +294,78 @@ ${OBJECTDIR}/cat.p1: cat.c  nbproject/Makefile-${CND_CONF}.mk
 	@-${MV} ${OBJECTDIR}/cat.d ${OBJECTDIR}/cat.p1.d 
 	@${FIXDEPS} ${OBJECTDIR}/cat.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
 	
+${OBJECTDIR}/flap.p1: flap.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flap.p1.d 
+	@${RM} ${OBJECTDIR}/flap.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/flap.p1 flap.c 
+	@-${MV} ${OBJECTDIR}/flap.d ${OBJECTDIR}/flap.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/flap.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/adc.p1: adc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/adc.p1.d 
+	@${RM} ${OBJECTDIR}/adc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/adc.p1 adc.c 
+	@-${MV} ${OBJECTDIR}/adc.d ${OBJECTDIR}/adc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/adc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/buzzer.p1: buzzer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/buzzer.p1.d 
+	@${RM} ${OBJECTDIR}/buzzer.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/buzzer.p1 buzzer.c 
+	@-${MV} ${OBJECTDIR}/buzzer.d ${OBJECTDIR}/buzzer.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/buzzer.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/sched.p1: sched.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sched.p1.d 
+	@${RM} ${OBJECTDIR}/sched.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/sched.p1 sched.c 
+	@-${MV} ${OBJECTDIR}/sched.d ${OBJECTDIR}/sched.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/sched.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/event.p1: event.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/event.p1.d 
+	@${RM} ${OBJECTDIR}/event.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/event.p1 event.c 
+	@-${MV} ${OBJECTDIR}/event.d ${OBJECTDIR}/event.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/event.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/crc.p1: crc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/crc.p1.d 
+	@${RM} ${OBJECTDIR}/crc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/crc.p1 crc.c 
+	@-${MV} ${OBJECTDIR}/crc.d ${OBJECTDIR}/crc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/crc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/config.p1: config.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/config.p1.d 
+	@${RM} ${OBJECTDIR}/config.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/config.p1 config.c 
+	@-${MV} ${OBJECTDIR}/config.d ${OBJECTDIR}/config.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/config.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/storage.p1: storage.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/storage.p1.d 
+	@${RM} ${OBJECTDIR}/storage.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/storage.p1 storage.c 
+	@-${MV} ${OBJECTDIR}/storage.d ${OBJECTDIR}/storage.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/storage.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/eeprom.p1: eeprom.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/eeprom.p1.d 
+	@${RM} ${OBJECTDIR}/eeprom.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -DFLAP_POT=1 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/eeprom.p1 eeprom.c 
+	@-${MV} ${OBJECTDIR}/eeprom.d ${OBJECTDIR}/eeprom.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/eeprom.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -7,6 +7,18 @@
 #include <xc.h>
 #include "peripherials.h"
 #include "interrupts.h"
+#include "rfid.h"
+
+#define LATCH_ALL 0x3
+
+//Latches state asked, one bit per latch (1 is locked)
+static uint8_t latchLock = 0;
+//Latches pulsed to the state asked (unknown at boot)
+static uint8_t latchDone = 0;
+//Pulse running
+static volatile bool latchActive = false;
+//Pulse time left (ms)
+static volatile uint16_t latchTicks = 0;
 
 /**
  * Initialize peripherials (I/O)
@@ -45,8 +57,8 @@ void initPeripherials(void)
     CCP2CON = 0x0;
     
     //Configure timer 1 (millis counter)
-    T1CONbits.T1CKPS1 = 1;   // bits 5-4  Prescaler Rate Select bits
-    T1CONbits.T1CKPS0 = 0;   // bit 4
+    T1CONbits.T1CKPS1 = (TMR1_CKPS>>1) & 1;  // bits 5-4  Prescaler Rate Select bits
+    T1CONbits.T1CKPS0 = TMR1_CKPS & 1;       // bit 4
     T1CONbits.T1OSCEN = 0;   // bit 3 Timer1 Oscillator Enable Control bit 1 = on
     T1CONbits.T1SYNC = 0;    // bit 2 Timer1 External Clock Input Synchronization Control bit...1 = Do not synchronize external clock input
     T1CONbits.TMR1CS = 0;    // bit 1 Timer1 Clock Source Select bit...0 = Internal clock (FOSC/4)
@@ -62,45 +74,69 @@ void initPeripherials(void)
 }
 
 
-uint16_t getLightSensor(void)
+/**
+ * Start a latch pulse
+ * @param latch LATCH_GREEN or LATCH_RED
+ * @param lock Lock or unlock
+ * @param pulse Pulse width (ms)
+ */
+static void startPulse(uint8_t latch, bool lock, uint16_t pulse)
 {
-    //Start ADC on channel 0
-    ADCON0 = 0b10000001;
-    //Wait for capacitor to charge
-    __delay_us(1000);
-    ADCON0bits.GO_DONE = true;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += (ADRESH<<8);
-    //Keep ADC on
-    ADCON0 = 0x1;    
-    return ret;
+    stopRFID();             //L293 is shared with RFID excitation
+    if(latch == LATCH_GREEN){
+        CL_GL_ENABLE = 1;       //Enable channel 1/2
+        RFID_RL_ENABLE = 0;     //Disable the 3/4 output
+        if(lock){
+            GREEN_LOCK = 0;     //Power the green lock
+            COMMON_LOCK = 1;    //Power the green lock
+        }else{
+            GREEN_LOCK = 1;     //Power the green lock
+            COMMON_LOCK = 0;    //Power the green lock
+        }
+    }else{
+        RFID_RL_ENABLE = 1;     //Enable channel 1/2
+        RFID_EXCT = 1;          //Force RFID to 1 (less consumption)
+        CL_GL_ENABLE = 1;       //Enable the 3/4 output
+        GREEN_LOCK = 1;         //Force green latch to 1 (to avoid burning I/O)
+        if(lock){
+            RED_LOCK = 0;       //Power the red lock
+            COMMON_LOCK = 1;    //Power the red lock        
+        }else{
+            RED_LOCK = 1;       //Power the red lock
+            COMMON_LOCK = 0;    //Power the red lock
+        }
+    }
+    //Pulse is ended by the millis interrupt
+    latchTicks = pulse;
+    latchActive = true;
+    L293_LOGIC = 1;         //Power the logic
 }
 
-#ifdef FLAP_POT
-uint16_t getFlapPosition(void)
+void latchISR(void)
 {
-    //Start ADC on channel 1
-    ADCON0 = 0b10000101;
-    //Wait for capacitor to charge
-    __delay_us(1000);
-    ADCON0bits.GO_DONE = true;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += (ADRESH<<8);
-    ADCON0 = 0x1;
-    return ret;
+    if(latchActive && (--latchTicks == 0)){
+        L293_LOGIC = 0;         //Power the logic
+        CL_GL_ENABLE = 0;       //Disable channel 1/2
+        RFID_RL_ENABLE = 0;     //Disable channel 3/4
+        GREEN_LOCK = 1;         //Put locks to 1 to avoid burning L293_LOGIC I/O
+        RED_LOCK = 1;           //Put locks to 1 to avoid burning L293_LOGIC I/O
+        COMMON_LOCK = 1;        //Put locks to 1 to avoid burning L293_LOGIC I/O
+        latchActive = false;
+    }
 }
 
-#endif
-
-void beep(void)
+/**
+ * Request a latch state
+ * @param latch LATCH_GREEN or LATCH_RED
+ * @param lock Lock or unlock
+ */
+static void setLatch(uint8_t latch, bool lock)
 {
-    for(uint16_t i=0;i<200;++i){
-        BUZZER = 1;
-        __delay_us(250);	
-		BUZZER = 0;
-		__delay_us(250);
+    uint8_t bit = 1<<latch;
+    if(((latchLock & bit) != 0) != lock){
+        latchLock ^= bit;
+        //Needs a pulse, even if one is running with the old state
+        latchDone &= ~bit;
     }
 }
 
@@ -109,22 +145,7 @@ void beep(void)
  */
 bool lockGreenLatch(bool lock)
 {
-    CL_GL_ENABLE = 1;       //Enable channel 1/2
-    RFID_RL_ENABLE = 0;     //Disable the 3/4 output
-    if(lock){
-        GREEN_LOCK = 0;     //Power the green lock
-        COMMON_LOCK = 1;    //Power the green lock
-    }else{
-        GREEN_LOCK = 1;     //Power the green lock
-        COMMON_LOCK = 0;    //Power the green lock
-    }
-    L293_LOGIC = 1;         //Power the logic
-    __delay_ms(500);
-    L293_LOGIC = 0;         //Power the logic
-    CL_GL_ENABLE = 0;       //Enable channel 1/2
-    GREEN_LOCK = 1;         //Put locks to 1 to avoid burning L293_LOGIC I/O
-    RED_LOCK = 1;           //Put locks to 1 to avoid burning L293_LOGIC I/O
-    COMMON_LOCK = 1;        //Put locks to 1 to avoid burning L293_LOGIC I/O
+    setLatch(LATCH_GREEN, lock);
     return lock;
 }
 
@@ -133,25 +154,28 @@ bool lockGreenLatch(bool lock)
  */
 bool lockRedLatch(bool lock)
 {
-    RFID_RL_ENABLE = 1;     //Enable channel 1/2
-    RFID_EXCT = 1;          //Force RFID to 1 (less consumption)
-    CL_GL_ENABLE = 1;       //Enable the 3/4 output
-    GREEN_LOCK = 1;         //Force green latch to 1 (to avoid burning I/O)
-    if(lock){
-        RED_LOCK = 0;       //Power the red lock
-        COMMON_LOCK = 1;    //Power the red lock        
-    }else{
-        RED_LOCK = 1;       //Power the red lock
-        COMMON_LOCK = 0;    //Power the red lock
-    }
-    L293_LOGIC = 1;         //Power the logic
-    __delay_ms(500);
-    L293_LOGIC = 0;         //Power the logic
-    CL_GL_ENABLE = 0;       //Disable channel 1/2
-    RFID_RL_ENABLE = 0;     //Disable channel 3/4
-    GREEN_LOCK = 1;         //Put locks to 1 to avoid burning L293_LOGIC I/O
-    RED_LOCK = 1;           //Put locks to 1 to avoid burning L293_LOGIC I/O
-    COMMON_LOCK = 1;        //Put locks to 1 to avoid burning L293_LOGIC I/O
+    setLatch(LATCH_RED, lock);
     return lock;
 }
 
+bool latchBusy(void)
+{
+    return latchActive || (latchDone != LATCH_ALL);
+}
+
+void latchTask(uint16_t pulse)
+{
+    if(latchActive || (pulse == 0)){
+        return;
+    }
+    for(uint8_t i=0;i<2;++i){
+        uint8_t bit = 1<<i;
+        if((latchDone & bit) == 0){
+            latchDone |= bit;
+            startPulse(i, (latchLock & bit) != 0, pulse);
+            //One latch at a time, L293 is shared
+            return;
+        }
+    }
+}
+
@@ -34,6 +34,7 @@
 #include <xc.h> // include processor files - each processor file is guarded.  
 #include <stdbool.h>       /* For true/false definition */
 #include <stdint.h>
+#include "timing.h"
 
 //RFID demodulated stream input
 #define RFID_STREAM PORTAbits.RA2
@@ -67,53 +68,45 @@
 #define RED_BTN PORTBbits.RB6
 //Green button. Internal pull-up required
 #define GREEN_BTN PORTBbits.RB7
-//RFID field frequency
-#define RFID_FREQ 134200
-
-// Timer 1 is configured with a 1:4 scaler
-// Given the CLK freq of 19,600,000 Hz, Fosc/4 = 4,900,000Hz
-//(Fosc/4)/Prescaler = 1,225,000 Hz
-// 1E-3/((1/(Fosc/4)/Prescaler)-1 = 1224
-// 0xFFFF - 1225 = 64331 -> 0xFB37
-//Timer 1 high bits preset
-#define TMR1_H_PRES 0xFB
-//Timer 1 low bits preset
-#define TMR1_L_PRES 0x37
-
 /**
  * Initialize peripherials (I/O)
  */
 void initPeripherials(void);
 
+//Latches
+#define LATCH_GREEN 0
+#define LATCH_RED 1
+
 /**
- * Read the light sensor
- * @return The ADC value
+ * Opens/close the green latch, pulsed later by latchTask() if the
+ * state changes
+ * @return lock
  */
-uint16_t getLightSensor(void);
+bool lockGreenLatch(bool lock);
 
-#ifdef FLAP_POT
 /**
- * Read the flap position
- * @return The ADC value
+ * Opens/close the red latch, pulsed later by latchTask() if the
+ * state changes
+ * @return lock
  */
-uint16_t getFlapPosition(void);
-
-#endif
+bool lockRedLatch(bool lock);
 
 /**
- * Beep
+ * Start the next latch pulse needed, call from the main loop
+ * @param pulse Pulse width (ms)
  */
-void beep(void);
+void latchTask(uint16_t pulse);
 
 /**
- * Opens/close the green latch
+ * Is a latch pulse running or waiting? (L293 is not free for RFID)
+ * @return true if busy
  */
-bool lockGreenLatch(bool lock);
+bool latchBusy(void);
 
 /**
- * Opens/close the red latch
+ * End latch pulses, called by the interrupt routine every millisecond
  */
-bool lockRedLatch(bool lock);
+void latchISR(void);
 
 #endif	/* XC_HEADER_TEMPLATE_H */
 
@@ -12,47 +12,125 @@
 #include "rfid.h"
 #include "peripherials.h"
 #include "interrupts.h"
+#include "crc.h"
+#include "adc.h"
 
-static bool nextBit = false;
+//ADC samples are taken RFID_SAMPLES_PER_BIT (8) times per FDX-B bit (see
+//timing.h), so a half bit is 4 samples. Level of a half bit is the
+//majority of its 3 middle samples. Every bit boundary has a transition, so
+//levels are decided on the 6 votes around each boundary.
+//No edge since this number of samples, signal is lost
+#define RFID_RUN_MAX 12
+//Number of alternating half bits before header trailing one (10 zeros)
+#define RFID_HEADER_HALVES 20
+//Samples to skip for analog + ADC to be stable (~2ms)
+#define RFID_SETTLE_SAMPLES (RFID_SAMPLE_FREQ/500)
+//Samples to look for a tag signal (4 bits, ~1ms)
+#define RFID_PROBE_SAMPLES (4*RFID_SAMPLES_PER_BIT)
+//Boundary confidence (votes margin out of 6) up to which it is weak
+#define RFID_WEAK_CONF 1
+//Minimum ADC swing of the stream (8 MSBs) when a tag is in the field
+#define RFID_CARRIER_MIN 32
+//Number of ID bytes after header (CRC follows)
+#define RFID_ID_BYTES 8
+//Number of extension bytes (after CRC)
+#define RFID_EXT_BYTES 3
+//Number of bytes after header (ID, CRC, extension)
+#define RFID_FRAME_BYTES (RFID_ID_BYTES+2+RFID_EXT_BYTES)
+//Byte holding the country code MSBs (bits 38-47)
+#define RFID_COUNTRY_BYTE 5
+//Highest country code (ISO 3166 or manufacturer code)
+#define RFID_COUNTRY_MAX 999
+//Time to find a header (ms)
+#define RFID_TIMEOUT 100
+//Time to wait between two reads (ms)
+#define RFID_RELAX_TIME 20
+//Time to wait after a read without tag (ms)
+#define RFID_IDLE_RELAX_TIME 50
 
-uint16_t readRFIDADCS(void){    
-    ADCON0 = 0b10001001;    
-    ADCON0bits.GO_DONE = 1;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += ((ADRESH & 0x3) <<8) ;            
-    return ret;
-}
+#if RFID_SAMPLES_PER_BIT != 8
+#error "Demodulator needs 8 samples per bit"
+#endif
 
-uint16_t readRFIDADC(void){
-    ADCON0 = 0b00001001;    
-    ADCON0bits.GO_DONE = 1;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += ((ADRESH & 0x3) <<8) ;   
-    return ret;
-}
+//Demodulator states
+#define RFID_IDLE 0
+#define RFID_SETTLE 1
+#define RFID_PROBE 2
+#define RFID_HUNT 3
+#define RFID_DATA 4
+#define RFID_DONE 5
+#define RFID_NO_TAG 6
 
-bool readRFIDBitADC(void){
-    
-    return readRFIDADC()>512;
-}
+//Demodulator state (written by ISR)
+static volatile uint8_t rfidState = RFID_IDLE;
+//Samples to skip/probe before searching the header
+static uint8_t settle = 0;
+//Stream low level (minimum while probing)
+static uint8_t loLevel = 0;
+//Stream high level (maximum while probing)
+static uint8_t hiLevel = 0;
+//Slicing level of the stream
+static uint8_t slice = 0x80;
+//Demodulator flags, one bit each to save RAM
+static struct{
+    unsigned lastLevel : 1;      //Last sampled level
+    unsigned edgePending : 1;    //Level changed on last sample, edge to be confirmed
+    unsigned prevHalf : 1;       //Level of last half bit (hunting) or of last bit boundary (data)
+    unsigned haveBoundary : 1;   //Last bit boundary level is known
+    unsigned afterBoundary : 1;  //Next half bit is the one after a bit boundary
+    unsigned crcBad : 1;         //CRC is bad, but a weak boundary may fix it
+    unsigned repaired : 1;       //Frame was fixed using CRC
+}demod;
+//Number of samples since last edge
+static uint8_t runLen = 0;
+//Sample index in the half bit
+static uint8_t phase = 0;
+//High samples in the half bit
+static uint8_t votes = 0;
+//Alternating half bits seen while hunting the header
+static uint8_t halves = 0;
+//Confidence of last bit boundary level (0-3)
+static uint8_t prevConf = 0;
+//Votes of the half bit before the boundary
+static uint8_t secondVotes = 0;
+//Bit index in the current 9 bits group (8 data + control)
+static uint8_t bitIdx = 0;
+//Index of the byte being received
+static uint8_t byteIdx = 0;
+//Byte being received
+static uint8_t curByte = 0;
+//Bit boundaries decided with a low confidence in the frame
+static uint8_t weakBounds = 0;
+//Weak boundaries between two data bits of the ID and CRC
+static uint8_t weakId = 0;
+//Position of the data bit before the weak boundary, the next bit shares it
+static uint8_t weakPos = 0;
+//Smallest stream swing during the frame
+static uint8_t margin = 0;
+//ID bytes (after header)
+static uint8_t frame[RFID_ID_BYTES];
+//CRC computed while receiving the ID
+static uint16_t crcComp = 0;
+//CRC read in the frame
+static uint16_t crcFrame = 0;
+//Reason of the last dropped frame
+static uint8_t rfidError = 0;
+//Time the read was started (16 LSBs)
+static uint16_t rfidStart = 0;
+//Time the last read was stopped (16 LSBs)
+static uint16_t rfidStop = 0;
+//Time to wait before next read
+static uint8_t rfidRelax = RFID_RELAX_TIME;
 
-bool readBit(){
-    bool ret = true;
-    bool next = nextBit;
-    for(uint8_t i=0;i<16;++i){
-        while(!PIR1bits.TMR2IF);
-        PIR1bits.TMR2IF = 0;
-        if(((i>7) && (i<11))){
-           bool b = readRFIDBitADC();
-           if(b != next){
-                ret = false;
-            } 
-            nextBit = !b;
-        }
-    }   
-    return ret;
+/**
+ * Update CRC with a byte
+ * @param crc Current CRC
+ * @param d Data byte
+ * @return New CRC
+ */
+static uint16_t crcByte(uint16_t crc, uint8_t d)
+{
+    return CRC_BYTE(crc, d);
 }
 
 void setRFIDPWM(bool on)
@@ -65,18 +143,15 @@ void setRFIDPWM(bool on)
         ADCON0bits.ADON = 1;
         //Disable output
         TRISCbits.TRISC2 = 1;
-        //we will use a prescaler of 1:1
-        //TODO: Compute this according to _XTAL_FREQ
-        PR2 = 0x24;     
+        //Carrier period, we will use a prescaler of 1:1
+        PR2 = RFID_PR2;
         //PWM mode
-        CCP1CON = 0b00011100;
+        CCP1CON = 0b00001100 | (RFID_DC1B<<4);
         //50% duty cycle        
-        CCPR1L = 0b00010010;
+        CCPR1L = RFID_CCPR1L;
         PIR1bits.TMR2IF = 0;
-        T2CON = 0b00001100; //Timer 2 ON, no prescaler. Post scaler to 1:2
-        //Wait for the new PWM cycle
-        //while(!PIR1bits.TMR2IF);
-        //PIR1bits.TMR2IF = 0;
+        //Timer 2 ON, no prescaler. Post scaler for 8 ticks per bit
+        T2CON = RFID_T2CON;
         //Enable output
         TRISCbits.TRISC2 = 0;
         //Power the L293
@@ -84,8 +159,7 @@ void setRFIDPWM(bool on)
         RED_LOCK = 1;       //Low output on red lock
         RFID_RL_ENABLE = 1; //Enable the 3/4 output
         L293_LOGIC = 1;     //Power the logic
-        //Wait for analog + ADC to be stable
-        __delay_ms(2);
+        //Analog + ADC stabilization is done by the demodulator
     }else{
         //Disable output
         L293_LOGIC = 0;
@@ -100,120 +174,337 @@ void setRFIDPWM(bool on)
     }
 }
 
-bool waitEdge(){
-    
-    bool v = readRFIDBitADC();
-    while(v == readRFIDBitADC()){}
-    return !v;
+/**
+ * Starts a background read
+ */
+static void startRFID(void)
+{
+    //Put excitation on
+    setRFIDPWM(true);
+    settle = RFID_SETTLE_SAMPLES;
+    rfidError = 0;
+    rfidRelax = RFID_RELAX_TIME;
+    rfidState = RFID_SETTLE;
+    rfidStart = (uint16_t)millis();
+    //RFID has priority on light and flap conversions
+    adcRFID(true);
+    //Left justified result, the demodulator only uses ADRESH
+    ADCON1bits.ADFM = 0;
+    //First conversion, next ones are started by the ISR
+    ADCON0 = ADC_CON0(ADC_RFID);
+    ADCON0bits.GO_DONE = 1;
+    PIE1bits.TMR2IE = 1;
+}
+
+void stopRFID(void)
+{
+    PIE1bits.TMR2IE = 0;
+    if(rfidState != RFID_IDLE){
+        rfidState = RFID_IDLE;
+        rfidStop = (uint16_t)millis();
+        //Put excitation off
+        setRFIDPWM(false);
+        //Other channels can be converted
+        adcRFID(false);
+    }
 }
 
 /**
- * Synchronize the RFID
- * @return 
+ * Restart the header search
  */
-uint8_t syncRFID(void){
-    //Wait for header    
-    ms_t t = millis();
-    while((millis()-t)<100){
-        if(readRFIDADCS()>200){
-            continue;                    
+static void huntRFID(void)
+{
+    rfidState = RFID_HUNT;
+    halves = 0;
+    runLen = 0;
+    demod.edgePending = false;
+}
+
+void rfidISR(void)
+{
+    //Get the conversion started on previous tick (8 MSBs)
+    uint8_t v = ADRESH;
+    ADCON0bits.GO_DONE = 1;
+    if(rfidState == RFID_SETTLE){
+        if(--settle == 0){
+            rfidState = RFID_PROBE;
+            settle = RFID_PROBE_SAMPLES;
+            loLevel = 0xFF;
+            hiLevel = 0;
+        }
+        return;
+    }
+    if(rfidState == RFID_PROBE){
+        //Check stream amplitude before looking for a header
+        if(v < loLevel){
+            loLevel = v;
         }
-        nextBit = waitEdge();        
-        bool found = true;
-        for(uint8_t k=0;k<10;++k){
-            if(readBit()){
-                found = false;
-                break;
+        if(v > hiLevel){
+            hiLevel = v;
+        }
+        if(--settle == 0){
+            if((uint8_t)(hiLevel-loLevel) < RFID_CARRIER_MIN){
+                //Nothing is modulating the field
+                rfidState = RFID_NO_TAG;
+                PIE1bits.TMR2IE = 0;
+            }else{
+                //Start slicing in the middle of the swing
+                slice = (uint8_t)(((uint16_t)hiLevel + loLevel)>>1);
+                huntRFID();
+                demod.lastLevel = (v > slice);
+                phase = 0;
+                votes = 0;
             }
         }
-        if(found){
-            return 0;
-        }        
+        return;
     }
-    return NO_HEADER;
+    bool level = (v > slice);
+    //Track the high and low levels of the stream
+    if(level){
+        hiLevel = (uint8_t)(((uint16_t)hiLevel + v)>>1);
+    }else{
+        loLevel = (uint8_t)(((uint16_t)loLevel + v)>>1);
+    }
+    if(level == demod.lastLevel){
+        demod.edgePending = false;
+        if(++runLen > RFID_RUN_MAX){
+            //No edge for too long
+            huntRFID();
+            return;
+        }
+    }else if(!demod.edgePending){
+        //Confirm the edge on next sample (single sample glitch)
+        demod.edgePending = true;
+        ++runLen;
+    }else{
+        //Edge confirmed, previous sample started a half bit
+        demod.lastLevel = level;
+        demod.edgePending = false;
+        runLen = 2;
+        //Follow amplitude drift, slice in the middle of the levels
+        slice = (uint8_t)(((uint16_t)hiLevel + loLevel)>>1);
+        //Relock phase on every edge, except one on the last sample of a
+        //half bit which is only counted in its votes
+        if((phase != 3) || ((rfidState == RFID_HUNT) && (halves == 0))){
+            phase = 1;
+            votes = 0;
+        }
+    }
+    //Vote on the samples in the middle of the half bit
+    if((phase != 0) && level){
+        ++votes;
+    }
+    if(phase != 3){
+        ++phase;
+        return;
+    }
+    phase = 0;
+    uint8_t hv = votes;
+    votes = 0;
+    if(rfidState == RFID_HUNT){
+        bool half = (hv >= 2);
+        if(half != demod.prevHalf){
+            if(halves < 0xFF){
+                ++halves;
+            }
+        }else if(halves >= RFID_HEADER_HALVES){
+            //Trailing one of the header, next half starts a bit
+            rfidState = RFID_DATA;
+            //This half is the one before the first bit boundary
+            secondVotes = hv;
+            demod.afterBoundary = true;
+            demod.haveBoundary = false;
+            bitIdx = 0;
+            byteIdx = 0;
+            crcComp = 0;
+            demod.crcBad = false;
+            weakBounds = 0;
+            weakId = 0;
+            margin = 0xFF;
+        }else{
+            halves = 0;
+        }
+        demod.prevHalf = half;
+        return;
+    }
+    if((uint8_t)(hiLevel-loLevel) < margin){
+        margin = hiLevel-loLevel;
+    }
+    if(!demod.afterBoundary){
+        //Keep votes, level is decided at the next bit boundary
+        secondVotes = hv;
+        demod.afterBoundary = true;
+        return;
+    }
+    demod.afterBoundary = false;
+    //Bit boundary always has a transition : votes of the half before it
+    //and inverted votes of the half after it give the same level
+    uint8_t sum = secondVotes + (3-hv);
+    bool boundary = (sum > 3);
+    uint8_t conf = boundary ? (sum-3) : (3-sum);
+    //A boundary is shared by two bits, it is counted once
+    if((conf <= RFID_WEAK_CONF) && (weakBounds < 0xFF)){
+        ++weakBounds;
+    }
+    if(!demod.haveBoundary){
+        //Boundary after the header, first bit ends at the next one
+        demod.haveBoundary = true;
+        demod.prevHalf = boundary;
+        prevConf = conf;
+        return;
+    }
+    //Differential bi-phase : one keeps the boundary of the previous boundary
+    bool bit = (boundary != demod.prevHalf);
+    bool weak = (conf <= RFID_WEAK_CONF) || (prevConf <= RFID_WEAK_CONF);
+    if(bitIdx < 8){
+        if((conf <= RFID_WEAK_CONF) && (bitIdx < 7) &&
+                (byteIdx < (RFID_ID_BYTES+2))){
+            //Candidate for repair by CRC. Boundaries next to a control bit
+            //are checked by it
+            ++weakId;
+            weakPos = (byteIdx<<3) | bitIdx;
+        }
+        //LSB first
+        curByte >>= 1;
+        if(bit){
+            curByte |= 0x80;
+        }
+        ++bitIdx;
+    }else{
+        //Control bit, always one
+        bitIdx = 0;
+        if(!bit){
+            if(!weak){
+                rfidError = BAD_START;
+                huntRFID();
+                return;
+            }
+            //Flip the least confident boundary
+            if(prevConf < conf){
+                //Shared with the last data bit of the byte
+                curByte ^= 0x80;
+            }else{
+                boundary = !boundary;
+                conf = 0;
+            }
+        }
+        //Byte is complete once its control bit is checked
+        if(byteIdx < RFID_ID_BYTES){
+            frame[byteIdx] = curByte;
+            crcComp = crcByte(crcComp, curByte);
+            if((byteIdx == RFID_COUNTRY_BYTE) && (weakId == 0) &&
+                    (((frame[4]>>6) | (curByte<<2)) > RFID_COUNTRY_MAX)){
+                //Not a valid country code
+                rfidError = BAD_COUNTRY;
+                huntRFID();
+                return;
+            }
+        }else if(byteIdx == RFID_ID_BYTES){
+            crcFrame = curByte;
+        }else if(byteIdx == (RFID_ID_BYTES+1)){
+            crcFrame |= (curByte<<8);
+            if(crcFrame != crcComp){
+                if(weakId != 1){
+                    //Drop it and wait for the next one
+                    rfidError = BAD_CRC;
+                    huntRFID();
+                    return;
+                }
+                //Single weak boundary, try to fix it when frame is complete
+                demod.crcBad = true;
+            }
+        }
+        //Extension bytes are only checked for their control bits
+        if(++byteIdx == RFID_FRAME_BYTES){
+            //Frame ready for the main loop
+            rfidState = RFID_DONE;
+            PIE1bits.TMR2IE = 0;
+            return;
+        }
+    }
+    demod.prevHalf = boundary;
+    prevConf = conf;
 }
 
-uint8_t readRFIDByte(uint8_t* d)
+/**
+ * Try to fix a frame with a single weak boundary
+ * @return true if CRC is good after flipping the boundary
+ */
+static bool repairFrame(void)
 {
-    *d = 0x0;
-    //Start bit
-//    if(readBit()){
-    readBit();
-        for(uint8_t i=0;i<8;++i){            
-            if(readBit()){
-                *d |= (1<<i);
-            }            
+    //Both bits sharing the boundary are flipped
+    uint8_t mask = (3 << (weakPos & 0x7));
+    if(weakPos < (RFID_ID_BYTES<<3)){
+        frame[weakPos>>3] ^= mask;
+        crcComp = 0;
+        for(uint8_t i=0;i<RFID_ID_BYTES;++i){
+            crcComp = crcByte(crcComp, frame[i]);
         }
-        return 0;
-/*    }else{
-        return BAD_START;
-    }*/
-}
-
-
-uint16_t get_crc_ccit(uint16_t crc, uint8_t d){
-  int8_t i;
-  uint16_t ret = crc;
-  for(i=0;i<8;++i){
-      bool b = ((d>>i) & 1);
-      bool c15 = ((ret >> 15 & 1) == 1);
-      ret <<=1;
-      if(c15 ^ b){
-          ret ^= 0x1021;
-      }
-  }
-  return ret;
-}
-
-
-uint16_t crc(uint8_t *p, uint8_t len){
-    uint16_t crcTmp = 0;
-    uint16_t ret = 0;
-    /* while there is more data to process */
-    while (len-- > 0) {
-        crcTmp = get_crc_ccit(crcTmp, *p);
-        p++;
-    }
-    ret = 0;
-    //Reverse bits
-    for(uint8_t i=0;i<16;++i){
-        ret |= ((crcTmp>>i) & 0x1) << (15-i);
-    }    
-    return ret;
+    }else if(weakPos < ((RFID_ID_BYTES+1)<<3)){
+        crcFrame ^= mask;
+    }else{
+        crcFrame ^= (mask<<8);
+    }
+    return crcFrame == crcComp;
 }
 
-uint8_t readRFID(uint8_t* id, uint8_t len, uint16_t* crcComputed,
+uint8_t pollRFID(uint8_t* id, uint8_t len, uint16_t* crcComputed,
         uint16_t* crcRead)
 {
-    uint8_t r=0;
-    //Put excitation on
-    setRFIDPWM(true);
-    //Wait for RFID synchro (up to 100ms)
-    r = syncRFID();    
-    if(r == 0){          
-        //Read only 10 bytes (after header)
-        uint8_t bytes[10];
-        for(uint8_t k=0;k<10;++k){
-            r = readRFIDByte(&bytes[k]);
-            if(r != 0){ 
-                break;
+    uint8_t r = RFID_BUSY;
+    switch(rfidState){
+        case RFID_IDLE:
+            //Relax between two reads
+            if((uint16_t)((uint16_t)millis()-rfidStop) > rfidRelax){
+                startRFID();
+            }
+            break;
+        case RFID_DONE:
+            r = 0;
+            //ISR is stopped before its flags are written
+            stopRFID();
+            //CRC already checked by the demodulator, unless a weak boundary
+            //has to be fixed
+            demod.repaired = demod.crcBad && repairFrame();
+            if(demod.crcBad && !demod.repaired){
+                r = BAD_CRC;
+                //Tag is in the field, retry at once
+                rfidRelax = 0;
             }
-        }
-        if(r == 0){      
             //Copy ID to array
             for(uint8_t i=0;i<len;++i){
-                id[i] = bytes[i];                    
+                id[i] = frame[i];
             }
-            //Compute CRC
-            *crcRead = bytes[8];
-            *crcRead |= (bytes[9]<<8);
-            *crcComputed = crc(bytes, 8); 
-            if(*crcRead != *crcComputed){
-                r = BAD_CRC;
+            *crcRead = crcFrame;
+            *crcComputed = crcComp;
+            break;
+        case RFID_NO_TAG:
+            r = NO_CARRIER;
+            stopRFID();
+            rfidRelax = RFID_IDLE_RELAX_TIME;
+            break;
+        case RFID_DATA:
+            //Let the frame finish
+            break;
+        default:
+            //Wait for RFID synchro (up to 100ms)
+            if((uint16_t)((uint16_t)millis()-rfidStart) > RFID_TIMEOUT){
+                r = NO_HEADER;
+                if(rfidError != 0){
+                    //Tag is in the field but frames are bad, retry at once
+                    r = rfidError;
+                    rfidRelax = 0;
+                }
+                stopRFID();
             }
-        }
+            break;
     }
-    //Put excitation off
-    setRFIDPWM(false);
     return r;
-}
\ No newline at end of file
+}
+
+void getRFIDQuality(RFIDQuality* q)
+{
+    q->weakBounds = weakBounds;
+    q->margin = margin;
+    q->repaired = demod.repaired;
+}
@@ -11,24 +11,54 @@
 #define	RFID_INCLUDED_H
 
 #include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
 
 #define NO_CARRIER 1
 #define NO_HEADER 2
 #define BAD_START 3
 #define BAD_CRC 4
+#define BAD_COUNTRY 5
+//Read still in progress
+#define RFID_BUSY 0xFF
 
 /**
- * Read RFID tag
+ * Quality of the last frame
+ */
+typedef struct{
+    uint8_t weakBounds;     //Bit boundaries decided with a low confidence
+    uint8_t margin;         //Smallest stream swing (ADC, 8 bits)
+    bool repaired;          //A weak boundary was fixed using the CRC
+}RFIDQuality;
+
+/**
+ * Poll the background RFID reader. A new read is started when idle.
  * @param id Array to store ID of tag
  * @param len Length of id
  * @param crcComputed The CRC computed from ID
  * @param crcRead The CRC read in packet
- * @return 0 on success
+ * @return RFID_BUSY while reading, 0 on success
  */
-uint8_t readRFID(uint8_t* id, uint8_t len, uint16_t* crcComputed,
+uint8_t pollRFID(uint8_t* id, uint8_t len, uint16_t* crcComputed,
         uint16_t* crcRead);
 
 void setRFIDPWM(bool on);
 
+/**
+ * Get quality of the last frame received (good or dropped)
+ * @param q Frame quality
+ */
+void getRFIDQuality(RFIDQuality* q);
+
+/**
+ * Abort the read in progress and put excitation off
+ */
+void stopRFID(void);
+
+/**
+ * RFID demodulator, called by the interrupt routine on Timer 2
+ */
+void rfidISR(void);
+
 #endif	/* XC_HEADER_TEMPLATE_H */
 
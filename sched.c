@@ -0,0 +1,89 @@
+/*
+ * File:   sched.c
+ * Author: mdonze
+ *
+ * Created on 16 October 2026, 20:10
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sched.h"
+#include "interrupts.h"
+
+//Next run of each task, low 16 bits of millis()
+static uint16_t due[SCHED_TASKS];
+//Scheduled tasks, one bit per task number
+static uint16_t scheduled = 0;
+//Worst lateness seen
+static uint16_t maxLate = 0;
+
+/**
+ * Bit of a task in scheduled
+ * @param task Task number
+ * @return Task bit
+ */
+static uint16_t taskBit(uint8_t task)
+{
+    return (uint16_t)1 << task;
+}
+
+void schedStart(uint8_t task)
+{
+    schedAfter(task, schedTasks[task].period);
+}
+
+void schedAfter(uint8_t task, uint16_t delay)
+{
+    due[task] = (uint16_t)millis() + delay;
+    scheduled |= taskBit(task);
+}
+
+void schedDelay(uint8_t task, uint16_t delay)
+{
+    due[task] = (uint16_t)millis() + delay;
+}
+
+void schedCancel(uint8_t task)
+{
+    scheduled &= ~taskBit(task);
+}
+
+bool schedPending(uint8_t task)
+{
+    return (scheduled & taskBit(task)) != 0;
+}
+
+void schedRun(void)
+{
+    uint16_t bit = 1;
+    for(uint8_t i=0;i<SCHED_TASKS;++i,bit<<=1){
+        if((scheduled & bit) == 0){
+            continue;
+        }
+        uint16_t late = (uint16_t)millis() - due[i];
+        if(late > SCHED_MAX_DELAY){
+            //Not due yet
+            continue;
+        }
+        if(late > maxLate){
+            maxLate = late;
+        }
+        uint16_t period = schedTasks[i].period;
+        if(period == SCHED_ONCE){
+            scheduled &= ~bit;
+        }else if(late >= period){
+            //Too late, runs missed are skipped
+            due[i] += late + period;
+        }else{
+            due[i] += period;
+        }
+        //Task can reschedule itself
+        schedTasks[i].fn();
+    }
+}
+
+uint16_t schedMaxLate(void)
+{
+    return maxLate;
+}
@@ -0,0 +1,115 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: sched.h
+ * Author: mdonze
+ * Comments: Cooperative scheduler for the main loop. Tasks are run from
+ *           schedRun() when due, they must not block.
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef SCHED_INCLUDED_H
+#define	SCHED_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+//Number of tasks, the main loop uses 9 (can be set by the build)
+#ifndef SCHED_TASKS
+#define SCHED_TASKS 9
+#endif
+#if SCHED_TASKS > 16
+#error "SCHED_TASKS must be 16 or less"
+#endif
+//Longest delay or period (ms), times are kept on 16 bits
+#define SCHED_MAX_DELAY 32767
+//Period of a task run once
+#define SCHED_ONCE 0xFFFF
+
+/**
+ * Task function
+ */
+typedef void (*TaskFn)(void);
+
+/**
+ * Task, the table lives in program memory
+ */
+typedef struct{
+    TaskFn fn;          //Task function
+    uint16_t period;    //Period (ms), 0 runs it on every schedRun(),
+                        //SCHED_ONCE for a one shot task
+}Task;
+
+/**
+ * Task table, by task number, defined by the application
+ */
+extern const Task schedTasks[SCHED_TASKS];
+
+/**
+ * Start a periodic task, first run after one period
+ * @param task Task number (lower runs first when several are due)
+ */
+void schedStart(uint8_t task);
+
+/**
+ * Schedule a task, a periodic one goes on with its period after this run
+ * @param task Task number (lower runs first when several are due)
+ * @param delay Delay before running (ms)
+ */
+void schedAfter(uint8_t task, uint16_t delay);
+
+/**
+ * Move the next run of a task (keeps its period)
+ * @param task Task number
+ * @param delay Delay before next run (ms)
+ */
+void schedDelay(uint8_t task, uint16_t delay);
+
+/**
+ * Stop a task
+ * @param task Task number
+ */
+void schedCancel(uint8_t task);
+
+/**
+ * Is a task waiting to run?
+ * @param task Task number
+ * @return true if scheduled
+ */
+bool schedPending(uint8_t task);
+
+/**
+ * Run every task due, call from the main loop
+ */
+void schedRun(void);
+
+/**
+ * Worst time a task was run after its deadline
+ * @return Lateness (ms)
+ */
+uint16_t schedMaxLate(void);
+
+#endif	/* SCHED_INCLUDED_H */
+
@@ -9,10 +9,55 @@
 #include <xc.h>
 #include <stdio.h>
 #include "interrupts.h"
+#include "crc.h"
 
+//Longest time between two bytes of a frame (ms)
 #define SERIAL_TIMEOUT 5
 
+//Baud rate generator values, by baud rate index
+static const uint16_t baudDividers[BAUD_COUNT] = {
+    UART_DIVIDER,
+    UART_DIVIDER_57600,
+    UART_DIVIDER_115200,
+    UART_DIVIDER_230400
+};
+
+//Frame parser states
+#define FRAME_WAIT 0
+#define FRAME_LEN 1
+#define FRAME_DATA 2
+#define FRAME_CRC_LO 3
+#define FRAME_CRC_HI 4
+//Frame checked, kept in the RX buffer until next pollFrame()
+#define FRAME_READY 5
+
 volatile struct RingBuffer rxBuffer;
+volatile struct TxRingBuffer txBuffer;
+//Bytes dropped on TX buffer overflow
+static uint16_t txDropped = 0;
+//Frame being sent does not fit in TX buffer
+static bool txSkip = false;
+//CRC of the frame being sent
+static uint16_t txCrc = 0;
+//Frame parser state
+static uint8_t frameState = FRAME_WAIT;
+//Length of the received frame
+static uint8_t frameLen = 0;
+//Bytes of the frame received so far
+static uint8_t frameIdx = 0;
+//CRC of the received frame
+static uint16_t frameCrc = 0;
+//Next RX buffer byte to parse, bytes from the frame start are kept until
+//the frame is checked
+static uint8_t frameScan = 0;
+//Baud rate switch waiting for TX to be empty
+static bool baudPending = false;
+//Baud rate index to switch to
+static uint8_t baudNext = BAUD_BOOT;
+//Baud rate switched, waiting for a frame from the host
+static bool baudCheck = false;
+//Time of the baud rate switch (16 LSBs)
+static uint16_t baudTime = 0;
 
 
 void initSerial(void)
@@ -20,8 +65,10 @@ void initSerial(void)
    //Pin for UART
    TRISC7 = 1;
    TRISC6 = 1;
-   //Clock divider
-   SPBRG = DIVIDER;
+   //Clock divider (16 bits)
+   BAUDCTLbits.BRG16 = 1;
+   SPBRGH = (UART_DIVIDER>>8) & 0xFF;
+   SPBRG = UART_DIVIDER & 0xFF;
    //Receive control register
    RCSTA = 0x0;
    //Serial port enabled
@@ -35,6 +82,12 @@ void initSerial(void)
    
    rxBuffer.rIndex = 0;
    rxBuffer.uIndex = 0;
+   rxBuffer.overruns = 0;
+   rxBuffer.framingErrors = 0;
+   rxBuffer.dropped = 0;
+   rxBuffer.lastRx = 0;
+   txBuffer.rIndex = 0;
+   txBuffer.uIndex = 0;
    
 }
 
@@ -44,59 +97,237 @@ void initSerial(void)
  */
 void putch(char byte)
 {
-	while(!TXIF)
-		continue;
-	TXREG = byte;
+    uint8_t next = txBuffer.uIndex+1;
+    if(next == SER_TX_BUFFER){
+        next = 0;
+    }
+    if(next == txBuffer.rIndex){
+        //Full, newest byte is dropped
+        if(txDropped < 0xFFFF){
+            ++txDropped;
+        }
+        return;
+    }
+    txBuffer.buffer[txBuffer.uIndex] = byte;
+    txBuffer.uIndex = next;
+    //Sent by the ISR
+    TXIE = 1;
+}
+
+void serialRxISR(void)
+{
+    //Empty the whole UART FIFO
+    while(RCIF){
+        //Framing error belongs to the byte on top of the FIFO
+        bool ferr = RCSTAbits.FERR;
+        uint8_t b = RCREG;
+        if(ferr){
+            if(rxBuffer.framingErrors != 0xFF){
+                ++rxBuffer.framingErrors;
+            }
+            continue;
+        }
+        uint8_t next = (rxBuffer.rIndex+1) & SER_MASK;
+        if(next == rxBuffer.uIndex){
+            //Full, newest byte is dropped
+            if(rxBuffer.dropped != 0xFF){
+                ++rxBuffer.dropped;
+            }
+            continue;
+        }
+        rxBuffer.buffer[rxBuffer.rIndex] = b;
+        rxBuffer.rIndex = next;
+    }
+    if(RCSTAbits.OERR){
+        //Receiver is stopped until CREN is toggled
+        RCSTAbits.CREN = 0;
+        RCSTAbits.CREN = 1;
+        if(rxBuffer.overruns != 0xFF){
+            ++rxBuffer.overruns;
+        }
+    }
+}
+
+/**
+ * Change the baud rate now
+ * @param idx Baud rate index
+ */
+static void applyBaud(uint8_t idx)
+{
+    SPBRGH = (baudDividers[idx]>>8) & 0xFF;
+    SPBRG = baudDividers[idx] & 0xFF;
+    //Bytes received around the switch are garbage
+    rxBuffer.uIndex = rxBuffer.rIndex;
+    frameScan = rxBuffer.rIndex;
+    frameState = FRAME_WAIT;
 }
 
-void putShort(uint16_t v){
-    putch(v & 0xFF);
-    putch((v>>8) & 0xFF);
+bool serialSetBaud(uint8_t idx)
+{
+    if(idx >= BAUD_COUNT){
+        return false;
+    }
+    baudNext = idx;
+    baudPending = true;
+    return true;
 }
 
-uint8_t getShort(uint16_t* v)
+void serialTask(void)
 {
-    ms_t start = millis();
-    while(rxBuffer.rIndex == rxBuffer.uIndex){
-        if((millis()-start)>SERIAL_TIMEOUT){
-            //Timeout
-            return 1;
+    if(baudPending){
+        //Answer must be fully sent at the old baud rate
+        if((txBuffer.rIndex == txBuffer.uIndex) && TXSTAbits.TRMT){
+            applyBaud(baudNext);
+            baudPending = false;
+            baudCheck = (baudNext != BAUD_BOOT);
+            baudTime = (uint16_t)millis();
         }
+    }else if(baudCheck && ((uint16_t)((uint16_t)millis()-baudTime) > BAUD_CONFIRM_TIME)){
+        //Host did not follow, back to the boot baud rate
+        applyBaud(BAUD_BOOT);
+        baudCheck = false;
     }
-    *v = rxBuffer.buffer[rxBuffer.uIndex];
-    if(++rxBuffer.uIndex == SER_BUFFER){
-        rxBuffer.uIndex = 0;
+}
+
+uint16_t getTxDropped(void)
+{
+    return txDropped;
+}
+
+uint8_t txFree(void)
+{
+    uint8_t used = txBuffer.uIndex - txBuffer.rIndex;
+    if(txBuffer.uIndex < txBuffer.rIndex){
+        used += SER_TX_BUFFER;
     }
-    while(rxBuffer.rIndex == rxBuffer.uIndex){
-        if((millis()-start)>SERIAL_TIMEOUT){
-            //Timeout
-            return 1;
+    return (SER_TX_BUFFER-1) - used;
+}
+
+void frameStart(uint8_t len)
+{
+    //Whole frame is dropped if it does not fit
+    txSkip = (txFree() < (len+4));
+    if(txSkip){
+        if(txDropped < (0xFFFF-(len+4))){
+            txDropped += len+4;
         }
+        return;
+    }
+    putch(FRAME_STX);
+    putch(len);
+    txCrc = CRC_BYTE(0, len);
+}
+
+void framePut(uint8_t b)
+{
+    if(!txSkip){
+        putch(b);
+        txCrc = CRC_BYTE(txCrc, b);
     }
-    *v |= (rxBuffer.buffer[rxBuffer.uIndex]<<8);
-    if(++rxBuffer.uIndex == SER_BUFFER){
-        rxBuffer.uIndex = 0;
+}
+
+void framePutShort(uint16_t v)
+{
+    framePut(v & 0xFF);
+    framePut((v>>8) & 0xFF);
+}
+
+void frameEnd(void)
+{
+    if(!txSkip){
+        putch(txCrc & 0xFF);
+        putch((txCrc>>8) & 0xFF);
     }
-    return 0;
 }
 
-uint8_t getByte(uint8_t* v)
+void frameNack(uint8_t reason, uint8_t cmd)
 {
-    ms_t start = millis();
-    while(rxBuffer.rIndex == rxBuffer.uIndex){
-        if((millis()-start)>SERIAL_TIMEOUT){
-            //Timeout
-            return 1;
+    frameStart(3);
+    framePut('N');
+    framePut(reason);
+    framePut(cmd);
+    frameEnd();
+}
+
+/**
+ * Drop the frame start being parsed, parsing starts again on the byte
+ * after it, where a real frame start may be
+ */
+static void frameResync(void)
+{
+    rxBuffer.uIndex = (rxBuffer.uIndex+1) & SER_MASK;
+    frameScan = rxBuffer.uIndex;
+    frameState = FRAME_WAIT;
+}
+
+uint8_t pollFrame(void)
+{
+    if(frameState == FRAME_READY){
+        //Last frame is handled
+        rxBuffer.uIndex = frameScan;
+        frameState = FRAME_WAIT;
+    }
+    while(frameScan != rxBuffer.rIndex){
+        uint8_t b = rxBuffer.buffer[frameScan];
+        frameScan = (frameScan+1) & SER_MASK;
+        switch(frameState){
+            case FRAME_WAIT:
+                //Anything else is skipped until a frame start
+                if(b == FRAME_STX){
+                    frameState = FRAME_LEN;
+                }else{
+                    rxBuffer.uIndex = frameScan;
+                }
+                break;
+            case FRAME_LEN:
+                if((b == 0) || (b > FRAME_MAX)){
+                    frameResync();
+                    return FRAME_BAD_LEN;
+                }
+                frameLen = b;
+                frameIdx = 0;
+                frameCrc = CRC_BYTE(0, b);
+                frameState = FRAME_DATA;
+                break;
+            case FRAME_DATA:
+                frameCrc = CRC_BYTE(frameCrc, b);
+                if(++frameIdx == frameLen){
+                    frameState = FRAME_CRC_LO;
+                }
+                break;
+            case FRAME_CRC_LO:
+                frameCrc ^= b;
+                frameState = FRAME_CRC_HI;
+                break;
+            default:
+                if((frameCrc ^ (b<<8)) != 0){
+                    frameResync();
+                    return FRAME_BAD_CRC;
+                }
+                //Frame is read from the RX buffer, next one is left there
+                frameState = FRAME_READY;
+                //Host talks at the new baud rate
+                baudCheck = false;
+                return FRAME_OK;
         }
     }
-    *v = rxBuffer.buffer[rxBuffer.uIndex];
-    if(++rxBuffer.uIndex == SER_BUFFER){
-       rxBuffer.uIndex = 0;
+    //Time since the last byte arrived, not since it was parsed
+    if((frameState != FRAME_WAIT) &&
+            ((uint8_t)((uint8_t)millis()-rxBuffer.lastRx) > SERIAL_TIMEOUT)){
+        //Half sent frame, wait for the next one
+        frameResync();
+        return FRAME_TIMEOUT;
     }
-    return 0;
+    return FRAME_NONE;
+}
+
+uint8_t getFrameLength(void)
+{
+    return frameLen;
 }
 
-bool byteAvail(void)
+uint8_t getFrameByte(uint8_t idx)
 {
-    return rxBuffer.rIndex != rxBuffer.uIndex;
-}
\ No newline at end of file
+    //After the frame start and length
+    return rxBuffer.buffer[(rxBuffer.uIndex+2+idx) & SER_MASK];
+}
@@ -35,36 +35,164 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-#define DIVIDER ((int)(_XTAL_FREQ/(16UL * 38400) -1))
+#include "timing.h"
 
 void initSerial(void);
 
+//Baud rate indexes
+//Boot baud rate (BAUD_RATE)
+#define BAUD_BOOT 0
+#define BAUD_57600 1
+#define BAUD_115200 2
+#define BAUD_230400 3
+#define BAUD_COUNT 4
+//Time for the host to send a frame after a baud rate switch (ms)
+#define BAUD_CONFIRM_TIME 2000
+
+/**
+ * Switch baud rate once everything queued is sent.
+ * The host must send a valid frame at the new baud rate within
+ * BAUD_CONFIRM_TIME, otherwise the boot baud rate is restored.
+ * @param idx Baud rate index
+ * @return false if idx is not a baud rate index
+ */
+bool serialSetBaud(uint8_t idx);
+
+/**
+ * Serial housekeeping (baud rate switch), call from the main loop
+ */
+void serialTask(void);
+
+/**
+ * Queue a byte for sending, dropped if TX buffer is full
+ * @param byte
+ */
 void putch(char byte);
-void putShort(uint16_t v);
 
-#define SER_BUFFER 16
+//RX buffer size, must be a power of two (can be set by the build)
+#ifndef SER_BUFFER
+#define SER_BUFFER 32
+#endif
+#if (SER_BUFFER < 2) || (SER_BUFFER > 128) || ((SER_BUFFER & (SER_BUFFER-1)) != 0)
+#error "SER_BUFFER must be a power of two between 2 and 128"
+#endif
+#define SER_MASK (SER_BUFFER-1)
 struct RingBuffer{
-        uint8_t rIndex;
-        uint8_t uIndex;
+        uint8_t rIndex;         //Next free byte (ISR)
+        uint8_t uIndex;         //Next byte to read (main)
+        uint8_t overruns;       //UART overruns (saturates)
+        uint8_t framingErrors;  //Bytes with framing error (saturates)
+        uint8_t dropped;        //Bytes dropped, buffer full (saturates)
+        uint8_t lastRx;         //Time of the last byte (ms, 8 LSBs, ISR)
         uint8_t buffer[SER_BUFFER];
 };
 extern volatile struct RingBuffer rxBuffer;
 
+//TX buffer size, holds the longest answer frame
+#define SER_TX_BUFFER 32
+struct TxRingBuffer{
+        uint8_t rIndex;     //Next byte to send (ISR)
+        uint8_t uIndex;     //Next free byte (main)
+        uint8_t buffer[SER_TX_BUFFER];
+};
+extern volatile struct TxRingBuffer txBuffer;
+
 /**
- * Read a short
- * @param v Value read
- * @return 0 on success
+ * Number of bytes dropped because TX buffer was full
+ * @return Dropped bytes count (saturates)
  */
-uint8_t getShort(uint16_t* v);
+uint16_t getTxDropped(void);
+
+/**
+ * Receive a byte from the UART, called by the ISR on RCIF
+ */
+void serialRxISR(void);
+
+/**
+ * Free room in TX buffer
+ * @return Number of bytes that can be queued
+ */
+uint8_t txFree(void);
+
+/**
+ * Frames (both ways) : FRAME_STX, length, command, data, CRC (LSB first).
+ * Length counts command and data. CRC is CRC-16/KERMIT of length, command
+ * and data.
+ */
+//Frame start
+#define FRAME_STX 0x02
+//Longest command and data
+#define FRAME_MAX 16
+//Frame being parsed stays in the RX buffer until it is checked
+#if (FRAME_MAX + 4) > (SER_BUFFER - 1)
+#error "SER_BUFFER cannot hold a whole frame"
+#endif
+#if (FRAME_MAX + 4) > (SER_TX_BUFFER - 1)
+#error "SER_TX_BUFFER cannot hold a whole frame"
+#endif
+//Answer to a bad frame or command : 'N', reason, command
+#define FRAME_NACK 'N'
+
+//Frame parser results, other than FRAME_NONE and FRAME_OK are NACK reasons
+#define FRAME_NONE 0
+#define FRAME_OK 1
+#define FRAME_BAD_LEN 2
+#define FRAME_BAD_CRC 3
+#define FRAME_TIMEOUT 4
+//Unknown command
+#define FRAME_BAD_CMD 5
+//Bad command arguments
+#define FRAME_BAD_ARG 6
 
 /**
- * Read a byte, with timeout
- * @param v Value read
- * @return 0 on success
+ * Parse received bytes up to the end of a frame, never waits
+ * @return FRAME_NONE, FRAME_OK or a NACK reason
  */
-uint8_t getByte(uint8_t* v);
+uint8_t pollFrame(void);
 
-bool byteAvail(void);
+/**
+ * Get the length of the last frame received
+ * @return Length of the frame (command and data)
+ */
+uint8_t getFrameLength(void);
+
+/**
+ * Get a byte of the last frame received, it stays in the RX buffer until
+ * next pollFrame()
+ * @param idx Index in the frame (0 is the command)
+ * @return Frame byte
+ */
+uint8_t getFrameByte(uint8_t idx);
+
+/**
+ * Start sending a frame, the whole frame is dropped if it does not fit
+ * @param len Length of command and data
+ */
+void frameStart(uint8_t len);
+
+/**
+ * Send a byte of a frame
+ * @param b
+ */
+void framePut(uint8_t b);
+
+/**
+ * Send a short of a frame (LSB first)
+ * @param v
+ */
+void framePutShort(uint16_t v);
+
+/**
+ * End a frame (sends the CRC)
+ */
+void frameEnd(void);
+
+/**
+ * Send a NACK frame
+ * @param reason NACK reason
+ * @param cmd Command refused (0 if unknown)
+ */
+void frameNack(uint8_t reason, uint8_t cmd);
 
 #endif	/* XC_HEADER_TEMPLATE_H */
 
@@ -0,0 +1,370 @@
+/*
+ * File:   storage.c
+ * Author: mdonze
+ *
+ * Created on 16 October 2026, 14:30
+ */
+
+#include <xc.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "storage.h"
+#include "eeprom.h"
+
+//No configuration key
+#define STORE_NO_KEY 0xFF
+
+//Configuration values (RAM shadow of the journal)
+static uint16_t cfgValue[STORE_KEYS];
+//Journal record holding the value of each key
+static uint8_t cfgRecord[STORE_KEYS];
+//Last journal record written
+static uint8_t journalHead = STORE_RECORDS-1;
+//Sequence number of the last record
+static uint8_t journalSeq = 0xFF;
+
+/**
+ * Check byte of a journal record
+ * @param r Record bytes (without check)
+ * @return Check byte
+ */
+static uint8_t recordCheck(uint8_t* r)
+{
+    uint8_t h = 0x5A;
+    for(uint8_t i=0;i<(STORE_RECORD_SIZE-1);++i){
+        h = ((h<<1) | (h>>7)) ^ r[i];
+    }
+    return h;
+}
+
+/**
+ * Read a journal record
+ * @param idx Record index
+ * @param r Record bytes
+ * @return true if the record is committed
+ */
+static bool readRecord(uint8_t idx, uint8_t* r)
+{
+    uint8_t offset = STORE_JOURNAL+idx*STORE_RECORD_SIZE;
+    for(uint8_t i=0;i<STORE_RECORD_SIZE;++i){
+        r[i] = eepromRead(offset+i);
+    }
+    return r[STORE_RECORD_SIZE-1] == recordCheck(r);
+}
+
+/**
+ * Key whose live value is in a journal record
+ * @param idx Record index
+ * @return Configuration key, STORE_NO_KEY if none
+ */
+static uint8_t recordKey(uint8_t idx)
+{
+    for(uint8_t k=0;k<STORE_KEYS;++k){
+        if(cfgRecord[k] == idx){
+            return k;
+        }
+    }
+    return STORE_NO_KEY;
+}
+
+/**
+ * Write a key in a journal record
+ * @param idx Record index
+ * @param key Configuration key
+ */
+static void writeRecord(uint8_t idx, uint8_t key)
+{
+    uint8_t r[STORE_RECORD_SIZE];
+    r[0] = ++journalSeq;
+    r[1] = key;
+    r[2] = cfgValue[key] & 0xFF;
+    r[3] = (cfgValue[key]>>8) & 0xFF;
+    r[4] = recordCheck(r);
+    //Queue keeps the order, check byte is written last
+    uint8_t offset = STORE_JOURNAL+idx*STORE_RECORD_SIZE;
+    for(uint8_t i=0;i<STORE_RECORD_SIZE;++i){
+        eepromWrite(offset+i, r[i]);
+    }
+    journalHead = idx;
+    cfgRecord[key] = idx;
+}
+
+/**
+ * Write a key at next journal record. Record after the head never holds a
+ * live value, so a torn write cannot lose one.
+ * @param key Configuration key
+ */
+static void appendRecord(uint8_t key)
+{
+    uint8_t k;
+    do{
+        uint8_t idx = journalHead+1;
+        if(idx == STORE_RECORDS){
+            idx = 0;
+        }
+        uint8_t next = idx+1;
+        if(next == STORE_RECORDS){
+            next = 0;
+        }
+        //Live value in the next record is moved first
+        k = recordKey(next);
+        if(k == key){
+            k = STORE_NO_KEY;
+        }
+        writeRecord(idx, (k != STORE_NO_KEY) ? k : key);
+    }while(k != STORE_NO_KEY);
+}
+
+/**
+ * Make a journal record invalid
+ * @param idx Record index
+ */
+static void dropRecord(uint8_t idx)
+{
+    uint8_t r[STORE_RECORD_SIZE];
+    readRecord(idx, r);
+    eepromWrite(STORE_JOURNAL+idx*STORE_RECORD_SIZE+STORE_RECORD_SIZE-1,
+            recordCheck(r) ^ 0xFF);
+}
+
+/**
+ * Check byte of a cat slot, the slot number is part of it so an ID left in
+ * another slot does not match
+ * @param slot Cat slot
+ * @param id Chip ID
+ * @return Check byte
+ */
+static uint8_t slotCheck(uint8_t slot, uint8_t* id)
+{
+    uint8_t h = 0xA5 ^ slot;
+    for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+        h = ((h<<1) | (h>>7)) ^ id[i];
+    }
+    return h;
+}
+
+/**
+ * Read the ID of a cat slot, without its check byte
+ * @param slot Cat slot
+ * @param id Chip ID
+ * @return true if the country code is valid
+ */
+static bool readSlot(uint8_t slot, uint8_t* id)
+{
+    uint8_t offset = CAT_OFFSET+slot*CAT_ID_SIZE;
+    for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+        id[i] = eepromRead(offset+i);
+    }
+    return (((id[4]>>6) | ((uint16_t)id[5]<<2)) <= CAT_COUNTRY_MAX);
+}
+
+/**
+ * Write the ID of a cat slot, without its check byte
+ * @param slot Cat slot
+ * @param id Chip ID
+ */
+static void writeSlot(uint8_t slot, uint8_t* id)
+{
+    uint8_t offset = CAT_OFFSET+slot*CAT_ID_SIZE;
+    for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+        eepromWrite(offset+i, id[i]);
+    }
+}
+
+/**
+ * Read a slot of the old layout (CRC + ID)
+ * @param slot Old cat slot
+ * @param id Chip ID, marked free if the slot was free
+ */
+static void readOldSlot(uint8_t slot, uint8_t* id)
+{
+    uint8_t offset = CAT_OFFSET+slot*CAT_OLD_SIZE;
+    uint16_t crc = eepromRead(offset);
+    crc |= (eepromRead(offset+1)<<8);
+    offset += 2;
+    for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+        id[i] = eepromRead(offset+i);
+    }
+    if(crc == 0x0){
+        id[CAT_ID_SIZE-1] = CAT_FREE;
+    }
+}
+
+/**
+ * Check byte of a packed slot not moved yet. It matches none of the IDs
+ * the slot holds while the old ID is written over it, byte after byte.
+ * @param slot Cat slot
+ * @param id Chip ID moved to the slot
+ * @return Check byte
+ */
+static uint8_t notMoved(uint8_t slot, uint8_t* id)
+{
+    uint8_t mix[CAT_ID_SIZE];
+    readSlot(slot, mix);
+    uint8_t check = slotCheck(slot, mix) ^ 0xFF;
+    bool clash;
+    do{
+        clash = false;
+        readSlot(slot, mix);
+        for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+            if(slotCheck(slot, mix) == check){
+                clash = true;
+            }
+            mix[i] = id[i];
+        }
+        if(clash){
+            ++check;
+        }
+    }while(clash);
+    return check;
+}
+
+/**
+ * First migration step from the old layout. Keys are journaled after the
+ * raw configuration words, old slots overwritten by their own packed slot
+ * are staged, and every packed slot is marked as not moved. Nothing of the
+ * old layout is written, so a power failure restarts the step.
+ */
+static void stageStorage(void)
+{
+    for(uint8_t k=0;k<STORE_KEYS;++k){
+        cfgValue[k] = eepromRead(k*2);
+        cfgValue[k] |= (eepromRead(k*2+1)<<8);
+        writeRecord(STORE_FIRST_RECORD+k, k);
+    }
+    uint8_t id[CAT_ID_SIZE];
+    for(uint8_t slot=0;slot<CAT_SLOTS;++slot){
+        if(slot < CAT_OLD_SLOTS){
+            readOldSlot(slot, id);
+        }else{
+            //Only freed
+            readSlot(slot, id);
+        }
+        if(slot < CAT_STAGED_SLOTS){
+            for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+                eepromWrite(STORE_STAGE+slot*CAT_ID_SIZE+i, id[i]);
+            }
+        }
+        eepromWrite(CAT_CHECK+slot, notMoved(slot, id));
+    }
+    eepromWrite(STORE_STAGED_ADDR, STORE_LAYOUT_STAGED);
+}
+
+/**
+ * Last migration step : old slots are moved to packed slots, in order. A
+ * packed slot only overwrites old slots already moved (or staged), and its
+ * check byte tells it was moved, so a power failure restarts the step.
+ */
+static void packStorage(void)
+{
+    uint8_t id[CAT_ID_SIZE];
+    for(uint8_t slot=0;slot<CAT_OLD_SLOTS;++slot){
+        readSlot(slot, id);
+        if(eepromRead(CAT_CHECK+slot) == slotCheck(slot, id)){
+            //Moved before a power failure
+            continue;
+        }
+        if(slot < CAT_STAGED_SLOTS){
+            for(uint8_t i=0;i<CAT_ID_SIZE;++i){
+                id[i] = eepromRead(STORE_STAGE+slot*CAT_ID_SIZE+i);
+            }
+        }else{
+            readOldSlot(slot, id);
+        }
+        storageWriteId(slot, id);
+    }
+    for(uint8_t slot=CAT_OLD_SLOTS;slot<CAT_SLOTS;++slot){
+        storageFreeId(slot);
+    }
+    //Raw configuration words and staged slots are left in the journal
+    for(uint8_t i=0;i<STORE_RECORDS;++i){
+        if((i < STORE_FIRST_RECORD) ||
+                (i >= (STORE_FIRST_RECORD+STORE_KEYS))){
+            dropRecord(i);
+        }
+    }
+    eepromWrite(STORE_LAYOUT_ADDR, STORE_LAYOUT);
+}
+
+/**
+ * Replay the configuration journal
+ */
+static void replayJournal(void)
+{
+    //Single pass : newest record of each key wins. Sequence numbers of
+    //live records are less than the number of records apart
+    uint8_t keySeq[STORE_KEYS];
+    bool any = false;
+    for(uint8_t i=0;i<STORE_RECORDS;++i){
+        uint8_t r[STORE_RECORD_SIZE];
+        if(!readRecord(i, r)){
+            //Never written, or torn by a power failure
+            continue;
+        }
+        if(!any || ((int8_t)(r[0]-journalSeq) > 0)){
+            any = true;
+            journalSeq = r[0];
+            journalHead = i;
+        }
+        uint8_t k = r[1];
+        if((k < STORE_KEYS) && ((cfgRecord[k] == STORE_NO_KEY) ||
+                ((int8_t)(r[0]-keySeq[k]) > 0))){
+            keySeq[k] = r[0];
+            cfgRecord[k] = i;
+            cfgValue[k] = r[2] | (r[3]<<8);
+        }
+    }
+}
+
+void initStorage(void)
+{
+    //Each migration step is restarted after a power failure, until its
+    //marker is written
+    if(eepromRead(STORE_LAYOUT_ADDR) != STORE_LAYOUT){
+        if(eepromRead(STORE_STAGED_ADDR) != STORE_LAYOUT_STAGED){
+            stageStorage();
+        }
+        packStorage();
+        eepromFlush();
+    }
+    for(uint8_t k=0;k<STORE_KEYS;++k){
+        cfgValue[k] = 0xFFFF;
+        cfgRecord[k] = STORE_NO_KEY;
+    }
+    replayJournal();
+}
+
+uint16_t storageGet(uint8_t key)
+{
+    if(key < STORE_KEYS){
+        return cfgValue[key];
+    }
+    return 0xFFFF;
+}
+
+void storageSet(uint8_t key, uint16_t value)
+{
+    if((key < STORE_KEYS) && (value != cfgValue[key])){
+        cfgValue[key] = value;
+        appendRecord(key);
+    }
+}
+
+bool storageReadId(uint8_t slot, uint8_t* id)
+{
+    //Country code (bits 38-47) and check byte
+    return readSlot(slot, id) &&
+            (eepromRead(CAT_CHECK+slot) == slotCheck(slot, id));
+}
+
+void storageWriteId(uint8_t slot, uint8_t* id)
+{
+    //Check byte commits the slot, queue keeps the order
+    writeSlot(slot, id);
+    eepromWrite(CAT_CHECK+slot, slotCheck(slot, id));
+}
+
+void storageFreeId(uint8_t slot)
+{
+    eepromWrite(CAT_OFFSET+slot*CAT_ID_SIZE+CAT_ID_SIZE-1, CAT_FREE);
+}
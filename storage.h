@@ -0,0 +1,130 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: storage.h
+ * Author: mdonze
+ * Comments: Power-fail safe EEPROM layout for configuration and cats
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef STORAGE_INCLUDED_H
+#define	STORAGE_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdint.h>
+#include <stdbool.h>
+
+//Configuration journal : circular log of records (sequence, key, value
+//LSB, value MSB, check). Check is written last and commits the record.
+#define STORE_JOURNAL 0
+//Size of a journal record
+#define STORE_RECORD_SIZE 5
+//Number of journal records
+#define STORE_RECORDS 20
+//Number of configuration keys
+#define STORE_KEYS 8
+//Layout markers, each one written once by the migration from the old
+//layout (configuration as raw 16 bits words, 16 slots of CRC + ID)
+#define STORE_LAYOUT_ADDR 126
+#define STORE_STAGED_ADDR 127
+//Old layout staged, old slots being moved to packed slots
+#define STORE_LAYOUT_STAGED 1
+//Journaled configuration and packed cats with check bytes
+#define STORE_LAYOUT 2
+//First journal record after the raw configuration words, keys are
+//journaled there by the migration
+#define STORE_FIRST_RECORD \
+    ((STORE_KEYS*2+STORE_RECORD_SIZE-1)/STORE_RECORD_SIZE)
+//Staging area of the old slots overwritten by their own packed slot, in
+//the journal records after the migrated keys
+#define STORE_STAGE \
+    (STORE_JOURNAL+(STORE_FIRST_RECORD+STORE_KEYS)*STORE_RECORD_SIZE)
+
+//Keep first 128 bytes for global settings
+#define CAT_OFFSET 128
+//Size of a cat slot : national ID (38 bits) and country code (10 bits)
+#define CAT_ID_SIZE 6
+//(256-128)/6
+#define CAT_SLOTS ((256-CAT_OFFSET)/CAT_ID_SIZE)
+//Last ID byte of a free slot (country code above 999)
+#define CAT_FREE 0xFF
+//Check bytes of the cat slots, after the journal. The check byte of a slot
+//is written after its ID and commits it
+#define CAT_CHECK (STORE_JOURNAL+STORE_RECORDS*STORE_RECORD_SIZE)
+//Highest valid country code
+#define CAT_COUNTRY_MAX 999
+//Old layout : 16 slots of CRC + ID
+#define CAT_OLD_SLOTS 16
+#define CAT_OLD_SIZE 8
+//Old slots overwritten by their own packed slot
+#define CAT_STAGED_SLOTS ((CAT_ID_SIZE-1)/(CAT_OLD_SIZE-CAT_ID_SIZE)+1)
+
+#if (STORE_STAGE + CAT_STAGED_SLOTS*CAT_ID_SIZE) > CAT_CHECK
+#error "Staged cats do not fit in the journal"
+#endif
+#if (CAT_CHECK + CAT_SLOTS) > STORE_LAYOUT_ADDR
+#error "Cat check bytes do not fit before the layout marker"
+#endif
+
+/**
+ * Migrate an old layout and replay the configuration journal (at boot)
+ */
+void initStorage(void);
+
+/**
+ * Get a configuration value
+ * @param key Configuration key
+ * @return Value, 0xFFFF if never set
+ */
+uint16_t storageGet(uint8_t key);
+
+/**
+ * Set a configuration value (appended to the journal)
+ * @param key Configuration key
+ * @param value Value
+ */
+void storageSet(uint8_t key, uint16_t value);
+
+/**
+ * Read a cat slot
+ * @param slot Cat slot
+ * @param id Chip ID
+ * @return true if the slot holds a valid ID
+ */
+bool storageReadId(uint8_t slot, uint8_t* id);
+
+/**
+ * Write a cat slot, the slot is only valid once its check byte is written
+ * @param slot Cat slot
+ * @param id Chip ID
+ */
+void storageWriteId(uint8_t slot, uint8_t* id);
+
+/**
+ * Free a cat slot
+ * @param slot Cat slot
+ */
+void storageFreeId(uint8_t slot);
+
+#endif	/* STORAGE_INCLUDED_H */
@@ -0,0 +1,108 @@
+/*
+ * File:   crc_test.c
+ * Author: mdonze
+ *
+ * Host test of the CRC table against the original bit by bit routine.
+ * Built and run by "make test" with the native compiler.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../crc.h"
+
+//Random frames to check
+#define TEST_FRAMES 1000000
+//Longest random frame (bytes)
+#define TEST_MAX_LEN 16
+
+/**
+ * Previous CRC-CCITT routine (MSB first, polynomial 0x1021)
+ * @param crc Current CRC
+ * @param d Data byte
+ * @return New CRC
+ */
+static uint16_t get_crc_ccit(uint16_t crc, uint8_t d){
+  int8_t i;
+  uint16_t ret = crc;
+  for(i=0;i<8;++i){
+      bool b = ((d>>i) & 1);
+      bool c15 = ((ret >> 15 & 1) == 1);
+      ret <<=1;
+      if(c15 ^ b){
+          ret ^= 0x1021;
+      }
+  }
+  return ret;
+}
+
+/**
+ * Previous frame CRC, with the final bit reversal
+ * @param p Data
+ * @param len Data length
+ * @return CRC as read in the frame
+ */
+static uint16_t crcBitwise(const uint8_t *p, uint8_t len){
+    uint16_t crcTmp = 0;
+    uint16_t ret = 0;
+    while (len-- > 0) {
+        crcTmp = get_crc_ccit(crcTmp, *p);
+        p++;
+    }
+    for(uint8_t i=0;i<16;++i){
+        ret |= ((crcTmp>>i) & 0x1) << (15-i);
+    }
+    return ret;
+}
+
+/**
+ * Table driven CRC, as used by the firmware
+ * @param p Data
+ * @param len Data length
+ * @return CRC
+ */
+static uint16_t crcTableDriven(const uint8_t *p, uint8_t len){
+    uint16_t crc = 0;
+    while (len-- > 0) {
+        crc = CRC_BYTE(crc, *p);
+        p++;
+    }
+    return crc;
+}
+
+int main(void){
+    uint8_t frame[TEST_MAX_LEN];
+    unsigned long errors = 0;
+
+    //CRC-16/KERMIT check value
+    if(crcTableDriven((const uint8_t*)"123456789", 9) != 0x2189){
+        printf("crc_test: bad check value\n");
+        ++errors;
+    }
+    //Every single byte
+    for(unsigned int v=0;v<256;++v){
+        frame[0] = (uint8_t)v;
+        if(crcTableDriven(frame, 1) != crcBitwise(frame, 1)){
+            printf("crc_test: mismatch on byte 0x%02X\n", v);
+            ++errors;
+        }
+    }
+    //Random frames, FDX-B frames are 8 bytes
+    srand(1);
+    for(unsigned long n=0;n<TEST_FRAMES;++n){
+        uint8_t len = (n & 1) ? 8 : (uint8_t)(rand() % (TEST_MAX_LEN + 1));
+        for(uint8_t i=0;i<len;++i){
+            frame[i] = (uint8_t)rand();
+        }
+        if(crcTableDriven(frame, len) != crcBitwise(frame, len)){
+            if(errors < 10){
+                printf("crc_test: mismatch on frame %lu\n", n);
+            }
+            ++errors;
+        }
+    }
+    printf("crc_test: %lu frames, %lu errors\n", (unsigned long)TEST_FRAMES,
+            errors);
+    return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
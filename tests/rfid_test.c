@@ -0,0 +1,266 @@
+/*
+ * File:   rfid_test.c
+ * Author: mdonze
+ *
+ * Host test of the FDX-B demodulator. The frame of a known tag is turned
+ * into ADC samples, weak bit boundaries are injected, and the samples are
+ * fed to the ISR. Built and run by "make test" with the native compiler.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "xc.h"
+#include "../rfid.h"
+#include "../crc.h"
+#include "../interrupts.h"
+#include "../timing.h"
+
+//ADC levels (8 MSBs) of the stream
+#define TEST_HI 200
+#define TEST_LO 50
+//Samples per half bit
+#define TEST_HALF (RFID_SAMPLES_PER_BIT/2)
+//Zeros before the header (settling, probing and hunting)
+#define TEST_LEAD_BITS 40
+//Bits after the header : 13 bytes of 8 data bits and a control bit
+#define TEST_FRAME_BITS (13*9)
+//Bits after the frame
+#define TEST_TAIL_BITS 20
+#define TEST_SAMPLES ((TEST_LEAD_BITS+11+TEST_FRAME_BITS+TEST_TAIL_BITS)*\
+        RFID_SAMPLES_PER_BIT)
+//Tag : country code and national ID
+#define TEST_COUNTRY 250ULL
+#define TEST_NATIONAL 123456789ULL
+
+//Register stand-ins (see tests/xc.h)
+volatile uint8_t ADCON0, ADRESH, CCP1CON, CCPR1L, PR2, T2CON;
+volatile HostBits ADCON0bits, ADCON1bits, PIE1bits, PIR1bits, T2CONbits,
+        TRISCbits, PORTAbits, PORTBbits, PORTCbits;
+
+//Time seen by the reader (ms)
+static ms_t now = 1000;
+//Frame bytes after the header (ID, CRC, extension)
+static uint8_t frameBytes[13];
+//ADC samples of the stream
+static uint8_t samples[TEST_SAMPLES];
+//First sample of each bit after the header
+static uint16_t bitStart[TEST_FRAME_BITS];
+//Number of samples
+static uint16_t sampleCount;
+//Level of the last half bit
+static bool lastHalf;
+
+ms_t millis(void)
+{
+    return now;
+}
+
+void adcRFID(bool on)
+{
+    (void)on;
+}
+
+/**
+ * Add a half bit to the stream
+ * @param high Level
+ */
+static void putHalf(bool high)
+{
+    for(uint8_t i=0;i<TEST_HALF;++i){
+        samples[sampleCount++] = high ? TEST_HI : TEST_LO;
+    }
+    lastHalf = high;
+}
+
+/**
+ * Add a bit to the stream (differential bi-phase : a transition at every
+ * bit boundary, one more in the middle of a zero)
+ * @param bit Bit value
+ */
+static void putBit(bool bit)
+{
+    putHalf(!lastHalf);
+    putHalf(bit ? lastHalf : !lastHalf);
+}
+
+/**
+ * Build the samples of a frame
+ */
+static void buildStream(void)
+{
+    uint64_t id = TEST_NATIONAL | (TEST_COUNTRY<<38) | (1ULL<<63);
+    uint16_t crc = 0;
+    for(uint8_t i=0;i<8;++i){
+        frameBytes[i] = (id >> (i*8)) & 0xFF;
+        crc = CRC_BYTE(crc, frameBytes[i]);
+    }
+    frameBytes[8] = crc & 0xFF;
+    frameBytes[9] = crc >> 8;
+    frameBytes[10] = 0;
+    frameBytes[11] = 0;
+    frameBytes[12] = 0;
+    sampleCount = 0;
+    lastHalf = false;
+    //Header : zeros and a trailing one
+    for(uint8_t i=0;i<(TEST_LEAD_BITS+10);++i){
+        putBit(false);
+    }
+    putBit(true);
+    uint8_t k = 0;
+    for(uint8_t b=0;b<13;++b){
+        for(uint8_t i=0;i<9;++i){
+            bitStart[k++] = sampleCount;
+            //LSB first, control bit is one
+            putBit((i == 8) || ((frameBytes[b] >> i) & 1));
+        }
+    }
+    for(uint8_t i=0;i<TEST_TAIL_BITS;++i){
+        putBit(false);
+    }
+}
+
+/**
+ * Make a boundary between two data bits weak and wrong : each half keeps
+ * its level on one vote less than the majority, without a confirmed edge
+ * @param byte Frame byte
+ * @param bit Data bit before the boundary (0-6), a zero followed by a one
+ * @return false if the bits around the boundary do not fit
+ */
+static bool weakenBoundary(uint8_t byte, uint8_t bit)
+{
+    if((bit > 6) || ((frameBytes[byte] >> bit) & 3) != 2){
+        return false;
+    }
+    uint8_t k = byte*9+bit;
+    uint8_t* before = &samples[bitStart[k]+TEST_HALF];
+    uint8_t* after = &samples[bitStart[k+1]];
+    uint8_t l = before[0];
+    uint8_t h = (l == TEST_HI) ? TEST_LO : TEST_HI;
+    const uint8_t beforeLevels[TEST_HALF] = {l, h, l, h};
+    const uint8_t afterLevels[TEST_HALF] = {l, h, l, l};
+    memcpy(before, beforeLevels, TEST_HALF);
+    memcpy(after, afterLevels, TEST_HALF);
+    return true;
+}
+
+/**
+ * Find the first data bit pair zero then one, from a frame byte
+ * @param byte First frame byte
+ * @param bit Data bit before the boundary
+ * @return Frame byte holding the pair
+ */
+static uint8_t findPair(uint8_t byte, uint8_t* bit)
+{
+    for(;byte<10;++byte){
+        for(uint8_t i=0;i<7;++i){
+            if(((frameBytes[byte] >> i) & 3) == 2){
+                *bit = i;
+                return byte;
+            }
+        }
+    }
+    return 0xFF;
+}
+
+/**
+ * Read the stream with the demodulator
+ * @param id ID bytes read
+ * @param q Frame quality
+ * @return pollRFID() result once the read is over
+ */
+static uint8_t readStream(uint8_t* id, RFIDQuality* q)
+{
+    uint16_t crcComputed, crcRead;
+    //Relax time after the previous read
+    now += 100;
+    pollRFID(id, 8, &crcComputed, &crcRead);
+    for(uint16_t i=0;(i<sampleCount) && PIE1bits.TMR2IE;++i){
+        ADRESH = samples[i];
+        rfidISR();
+    }
+    uint8_t r = pollRFID(id, 8, &crcComputed, &crcRead);
+    if(r == RFID_BUSY){
+        //Frame was dropped, read times out
+        now += 200;
+        r = pollRFID(id, 8, &crcComputed, &crcRead);
+    }else if((r == 0) && (crcComputed != crcRead)){
+        r = BAD_CRC;
+    }
+    getRFIDQuality(q);
+    return r;
+}
+
+/**
+ * Read a stream and check the result
+ * @param name Test name
+ * @param result Expected pollRFID() result
+ * @param weak Expected weak boundaries (result 0 only)
+ * @param repaired Expected repair (result 0 only)
+ * @return Number of errors
+ */
+static int check(const char* name, uint8_t result, uint8_t weak,
+        bool repaired)
+{
+    uint8_t id[8];
+    RFIDQuality q;
+    uint8_t r = readStream(id, &q);
+    if(r != result){
+        printf("%s: result %u, expected %u\n", name, r, result);
+        return 1;
+    }
+    if(r != 0){
+        return 0;
+    }
+    if(memcmp(id, frameBytes, 8) != 0){
+        printf("%s: wrong ID\n", name);
+        return 1;
+    }
+    if((q.weakBounds != weak) || (q.repaired != repaired)){
+        printf("%s: %u weak boundaries, repaired %u, expected %u, %u\n",
+                name, q.weakBounds, q.repaired, weak, repaired);
+        return 1;
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int errors = 0;
+    uint8_t bit, byte;
+
+    buildStream();
+    errors += check("clean frame", 0, 0, false);
+
+    //Every single weak boundary inside the ID and CRC is repaired
+    int repairs = 0;
+    for(uint8_t b=0;b<10;++b){
+        for(uint8_t i=0;i<7;++i){
+            buildStream();
+            if(weakenBoundary(b, i)){
+                errors += check("weak boundary", 0, 1, true);
+                ++repairs;
+            }
+        }
+    }
+    if(repairs == 0){
+        printf("no boundary to weaken\n");
+        ++errors;
+    }
+
+    //Two weak boundaries cannot be repaired, frame is dropped
+    buildStream();
+    byte = findPair(0, &bit);
+    weakenBoundary(byte, bit);
+    byte = findPair(byte+1, &bit);
+    if((byte == 0xFF) || !weakenBoundary(byte, bit)){
+        printf("no second boundary to weaken\n");
+        ++errors;
+    }
+    errors += check("two weak boundaries", BAD_CRC, 0, false);
+
+    printf("rfid_test: %d single weak boundaries, %d errors\n", repairs,
+            errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * File:   xc.h
+ * Author: mdonze
+ *
+ * Host stand-in for the XC8 device header, used by the host tests. Only
+ * the PIC16F886 registers touched by the modules under test, as plain
+ * variables defined by the test.
+ */
+
+#ifndef XC_HOST_H
+#define	XC_HOST_H
+
+#include <stdint.h>
+
+/**
+ * Bits of the registers used, one structure for all of them
+ */
+typedef struct{
+    unsigned GO_DONE : 1;
+    unsigned ADON : 1;
+    unsigned ADFM : 1;
+    unsigned TMR2IE : 1;
+    unsigned TMR2IF : 1;
+    unsigned TMR2ON : 1;
+    unsigned TRISC2 : 1;
+    unsigned RA2 : 1;
+    unsigned RA5 : 1;
+    unsigned RB0 : 1;
+    unsigned RB1 : 1;
+    unsigned RB2 : 1;
+    unsigned RB3 : 1;
+    unsigned RB4 : 1;
+    unsigned RB5 : 1;
+    unsigned RB6 : 1;
+    unsigned RB7 : 1;
+    unsigned RC0 : 1;
+    unsigned RC1 : 1;
+    unsigned RC2 : 1;
+    unsigned RC3 : 1;
+    unsigned RC4 : 1;
+    unsigned RC5 : 1;
+}HostBits;
+
+extern volatile uint8_t ADCON0, ADRESH, CCP1CON, CCPR1L, PR2, T2CON;
+extern volatile HostBits ADCON0bits, ADCON1bits, PIE1bits, PIR1bits,
+        T2CONbits, TRISCbits, PORTAbits, PORTBbits, PORTCbits;
+
+#define di()
+#define ei()
+
+#endif	/* XC_HOST_H */
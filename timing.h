@@ -0,0 +1,280 @@
+/* Microchip Technology Inc. and its subsidiaries.  You may use this software 
+ * and any derivatives exclusively with Microchip products. 
+ * 
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS".  NO WARRANTIES, WHETHER 
+ * EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+ * WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A 
+ * PARTICULAR PURPOSE, OR ITS INTERACTION WITH MICROCHIP PRODUCTS, COMBINATION 
+ * WITH ANY OTHER PRODUCTS, OR USE IN ANY APPLICATION. 
+ *
+ * IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+ * INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+ * WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+ * BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE 
+ * FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS 
+ * IN ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF 
+ * ANY, THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ * MICROCHIP PROVIDES THIS SOFTWARE CONDITIONALLY UPON YOUR ACCEPTANCE OF THESE 
+ * TERMS. 
+ */
+
+/* 
+ * File: timing.h
+ * Author: mdonze
+ * Comments: Timer, PWM, ADC and UART settings computed from the clock.
+ *           _XTAL_FREQ is the CPU clock (after PLL if any), set in the
+ *           project configuration. Other values can be overridden by
+ *           defining them in the build.
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef TIMING_INCLUDED_H
+#define	TIMING_INCLUDED_H
+
+#ifndef _XTAL_FREQ
+#error "_XTAL_FREQ must be set to the CPU clock frequency"
+#endif
+
+//Integer division rounded to nearest
+#define DIV_ROUND(a, b) (((a) + ((b)/2)) / (b))
+
+//Instruction clock (Fosc/4)
+#define FCY (_XTAL_FREQ/4)
+
+/*
+ * RFID excitation (Timer 2 + CCP1 PWM)
+ */
+//RFID field frequency
+#ifndef RFID_FREQ
+#define RFID_FREQ 134200
+#endif
+//Highest carrier error (per thousand)
+#define RFID_FREQ_TOL 20
+//Timer 2 period, no prescaler
+#define RFID_PR2 (DIV_ROUND(FCY, RFID_FREQ) - 1)
+//Carrier frequency really generated
+#define RFID_CARRIER (FCY / (RFID_PR2 + 1))
+//50% duty cycle, 10 bits value is 2*(PR2+1)
+#define RFID_CCPR1L ((RFID_PR2 + 1) >> 1)
+//Duty cycle 2 LSBs (CCP1CON<5:4>)
+#define RFID_DC1B (((RFID_PR2 + 1) & 0x1) << 1)
+//Carrier cycles in a FDX-B bit
+#define RFID_CYCLES_PER_BIT 32
+//ADC samples in a FDX-B bit (demodulator works on half bits of 4 samples)
+#define RFID_SAMPLES_PER_BIT 8
+//Timer 2 postscaler, one interrupt per sample
+#define RFID_POSTSCALE (RFID_CYCLES_PER_BIT / RFID_SAMPLES_PER_BIT)
+//Timer 2 on, no prescaler
+#define RFID_T2CON (((RFID_POSTSCALE - 1) << 3) | 0b100)
+//Sampling frequency of the demodulated stream
+#define RFID_SAMPLE_FREQ (RFID_CARRIER / RFID_POSTSCALE)
+//Instructions between two samples (demodulator ISR budget)
+#define RFID_SAMPLE_CYCLES ((RFID_PR2 + 1) * RFID_POSTSCALE)
+
+/*
+ * Interrupt budget while the RFID reader runs (instructions)
+ * These are estimates read from the C source, NOT measurements : none of
+ * them, the CRC table lookup included, has been timed on the target or in
+ * the simulator. To measure one, run the image in MPLAB SIM with the
+ * stopwatch reset on a breakpoint at the first instruction of isr(), set
+ * the flags of the sources to time in the SFR window, and read the cycles
+ * at its retfie. On target, the 'D' answer counts the samples taken late.
+ * While the reader samples, an entry services the sample (and the UART
+ * receiver), or a single other source : a sample waits behind one source.
+ */
+//Interrupt entry, context save and restore, test of the sources
+#define ISR_ENTRY_CYCLES 30
+//Demodulator, one sample
+#define ISR_RFID_CYCLES 90
+//Demodulator, extra for a complete byte (CRC, once every 72 samples)
+#define ISR_RFID_BYTE_CYCLES 50
+//UART byte received
+#define ISR_RX_CYCLES 30
+//Millisecond tick (Timer 1 preset, latch and buzzer steps)
+#define ISR_TICK_CYCLES 40
+//Buzzer square wave (Timer 0, every half period of the tone)
+#define ISR_TONE_CYCLES 6
+//Next queued EEPROM write
+#define ISR_EEPROM_CYCLES 30
+//UART byte sent
+#define ISR_TX_CYCLES 15
+//The ADC interrupt is off while the RFID reader owns the ADC
+//Share of the budget kept free for the error of the estimates (percent).
+//Sampling alone takes about 80% of the instructions during a read
+#ifndef ISR_HEADROOM
+#define ISR_HEADROOM 5
+#endif
+//Larger of two values
+#define ISR_MAX(a, b) (((a) > (b)) ? (a) : (b))
+//Interrupt entry with only a sample to take
+#define RFID_ISR_CYCLES (ISR_ENTRY_CYCLES + ISR_RFID_CYCLES)
+//Worst entry taking a sample: a byte is completed and a byte is received
+#define ISR_SAMPLE_CYCLES (RFID_ISR_CYCLES + ISR_RFID_BYTE_CYCLES + \
+        ISR_RX_CYCLES)
+//Worst entry a sample waits behind: the longest single source, buzzer tone
+//entries included (Timer 0 runs at twice the tone frequency during reads)
+#define ISR_WAIT_CYCLES (ISR_ENTRY_CYCLES + \
+        ISR_MAX(ISR_MAX(ISR_RX_CYCLES, ISR_TICK_CYCLES), \
+        ISR_MAX(ISR_MAX(ISR_TONE_CYCLES, ISR_EEPROM_CYCLES), ISR_TX_CYCLES)))
+//Worst delay before a sample is taken, and the entry taking it
+#define ISR_WORST_CYCLES (ISR_WAIT_CYCLES + ISR_SAMPLE_CYCLES)
+//Budget left once the headroom is taken out
+#define ISR_BUDGET(cycles) (((cycles) * (100 - ISR_HEADROOM)) / 100)
+
+#if (RFID_PR2 > 255) || (RFID_PR2 < 1)
+#error "RFID carrier cannot be made with Timer 2 without prescaler"
+#endif
+#if ((RFID_CARRIER - RFID_FREQ) * 1000 > RFID_FREQ_TOL * RFID_FREQ) || \
+    ((RFID_FREQ - RFID_CARRIER) * 1000 > RFID_FREQ_TOL * RFID_FREQ)
+#error "RFID carrier too far from RFID_FREQ"
+#endif
+#if ISR_BUDGET(RFID_SAMPLE_CYCLES) < RFID_ISR_CYCLES
+#error "Clock too slow for the RFID demodulator"
+#endif
+//A late sample is fine as long as no Timer 2 flag is lost
+#if ISR_BUDGET(2 * RFID_SAMPLE_CYCLES) < ISR_WORST_CYCLES
+#error "Interrupt sources can make the RFID demodulator lose a sample"
+#endif
+
+/*
+ * ADC
+ */
+//Conversion clock (ADCON0<7:6>), TAD must be at least 1.6us
+#if _XTAL_FREQ <= 1250000
+#define ADC_ADCS (0b00 << 6)
+#define ADC_TAD_DIV 2
+#elif _XTAL_FREQ <= 5000000
+#define ADC_ADCS (0b01 << 6)
+#define ADC_TAD_DIV 8
+#elif _XTAL_FREQ <= 20000000
+#define ADC_ADCS (0b10 << 6)
+#define ADC_TAD_DIV 32
+#else
+#error "No ADC clock for this _XTAL_FREQ"
+#endif
+//Acquisition time (us), datasheet TACQ is 4.67us with a 10k source at 50C
+#define ADC_TACQ_US 5
+//Instructions for an acquisition and a conversion (11 TAD)
+#define ADC_CYCLES (((FCY / 1000) * ADC_TACQ_US / 1000) + ((11 * ADC_TAD_DIV) / 4))
+
+#if ADC_CYCLES > RFID_SAMPLE_CYCLES
+#error "ADC too slow for the RFID sampling rate"
+#endif
+
+/*
+ * Timer 1 (millis counter)
+ */
+//Timer 1 prescaler
+#ifndef TMR1_PRESCALE
+#define TMR1_PRESCALE 4
+#endif
+//Highest tick error (per million)
+#define TMR1_TOL 1000
+//Timer 1 counts per millisecond
+#define TMR1_COUNT DIV_ROUND(FCY / TMR1_PRESCALE, 1000)
+//Timer 1 preset, overflows after TMR1_COUNT
+#define TMR1_PRES (65536 - TMR1_COUNT)
+//Timer 1 high bits preset
+#define TMR1_H_PRES ((TMR1_PRES >> 8) & 0xFF)
+//Timer 1 low bits preset
+#define TMR1_L_PRES (TMR1_PRES & 0xFF)
+//Prescaler select bits (T1CON<5:4>)
+#if TMR1_PRESCALE == 1
+#define TMR1_CKPS 0
+#elif TMR1_PRESCALE == 2
+#define TMR1_CKPS 1
+#elif TMR1_PRESCALE == 4
+#define TMR1_CKPS 2
+#elif TMR1_PRESCALE == 8
+#define TMR1_CKPS 3
+#else
+#error "Timer 1 prescaler must be 1, 2, 4 or 8"
+#endif
+
+#if (TMR1_COUNT > 65535) || (TMR1_COUNT < 256)
+#error "Timer 1 prescaler does not fit this _XTAL_FREQ"
+#endif
+#if ((TMR1_COUNT * TMR1_PRESCALE * 1000 - FCY) * 1000 > TMR1_TOL * (FCY / 1000)) || \
+    ((FCY - TMR1_COUNT * TMR1_PRESCALE * 1000) * 1000 > TMR1_TOL * (FCY / 1000))
+#error "Timer 1 tick too far from 1ms"
+#endif
+
+/*
+ * Timer 0 (buzzer tone)
+ */
+//Buzzer tone frequency
+#ifndef BUZZER_FREQ
+#define BUZZER_FREQ 2000
+#endif
+//Timer 0 prescaler
+#define TMR0_PRESCALE 8
+//Prescaler select bits (OPTION_REG<2:0>)
+#if TMR0_PRESCALE == 2
+#define TMR0_PS 0
+#elif TMR0_PRESCALE == 4
+#define TMR0_PS 1
+#elif TMR0_PRESCALE == 8
+#define TMR0_PS 2
+#elif TMR0_PRESCALE == 16
+#define TMR0_PS 3
+#elif TMR0_PRESCALE == 32
+#define TMR0_PS 4
+#elif TMR0_PRESCALE == 64
+#define TMR0_PS 5
+#elif TMR0_PRESCALE == 128
+#define TMR0_PS 6
+#elif TMR0_PRESCALE == 256
+#define TMR0_PS 7
+#else
+#error "Timer 0 prescaler must be a power of two from 2 to 256"
+#endif
+//Timer 0 counts per half period of the tone
+#define TMR0_COUNT DIV_ROUND(FCY / TMR0_PRESCALE, 2 * BUZZER_FREQ)
+//Timer 0 preset, overflows after TMR0_COUNT
+#define TMR0_PRES (256 - TMR0_COUNT)
+
+#if (TMR0_COUNT > 255) || (TMR0_COUNT < 32)
+#error "Buzzer tone cannot be made with Timer 0 at this _XTAL_FREQ"
+#endif
+
+/*
+ * UART (16 bits baud rate generator, BRG16 = 1, BRGH = 1)
+ */
+//Serial baud rate at boot, and after a failed baud rate switch
+#ifndef BAUD_RATE
+#define BAUD_RATE 38400
+#endif
+//Highest baud rate error (per thousand)
+#define BAUD_TOL 20
+//Baud rate generator value for a baud rate
+#define UART_DIV(baud) (DIV_ROUND(_XTAL_FREQ, 4 * (baud)) - 1)
+//Baud rate really generated
+#define UART_REAL(baud) (_XTAL_FREQ / (4 * (UART_DIV(baud) + 1)))
+//Baud rate cannot be made, or too far from the one asked
+#define UART_BAD(baud) ((UART_DIV(baud) > 65535) || (UART_DIV(baud) < 1) || \
+    ((UART_REAL(baud) - (baud)) * 1000 > BAUD_TOL * (baud)) || \
+    (((baud) - UART_REAL(baud)) * 1000 > BAUD_TOL * (baud)))
+//Baud rate generator value at boot
+#define UART_DIVIDER UART_DIV(BAUD_RATE)
+//Baud rate generator values for the baud rates the host can switch to
+#define UART_DIVIDER_57600 UART_DIV(57600)
+#define UART_DIVIDER_115200 UART_DIV(115200)
+#define UART_DIVIDER_230400 UART_DIV(230400)
+
+#if UART_BAD(BAUD_RATE)
+#error "BAUD_RATE cannot be made from this _XTAL_FREQ"
+#endif
+#if UART_BAD(57600)
+#error "57600 bauds cannot be made from this _XTAL_FREQ"
+#endif
+#if UART_BAD(115200)
+#error "115200 bauds cannot be made from this _XTAL_FREQ"
+#endif
+#if UART_BAD(230400)
+#error "230400 bauds cannot be made from this _XTAL_FREQ"
+#endif
+
+#endif	/* TIMING_INCLUDED_H */
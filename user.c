@@ -10,6 +10,8 @@
 #include "user.h"
 #include "serial.h"
 #include "peripherials.h"
+#include "cat.h"
+#include "buzzer.h"
 /******************************************************************************/
 /* User Functions                                                             */
 /******************************************************************************/
@@ -19,6 +21,9 @@
 void InitApp(void)
 {
     initPeripherials();
+    initBuzzer();
     initSerial();
+    initStorage();
+    initCats();
 }
 